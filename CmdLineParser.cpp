@@ -1,7 +1,9 @@
 
 //---------------------------------------------------------------------------
 
-#include "nanoxim.h"
+#include <sstream>
+#include "CmdLineParser.h"
+#include "TLog.h"
 
 //---------------------------------------------------------------------------
 //
@@ -10,11 +12,23 @@ void showHelp(char selfname[])
 {
   cout << "Usage: " << selfname << " [options]\nwhere [options] is one or more of the following ones:" << endl;
   cout << "\t-help\t\tShow this help and exit" << endl;
-  cout << "\t-verbose N\tVerbosity level (1=low, 2=medium, 3=high, default off)" << endl;
+  cout << "\t-verbose N\tVerbosity level (1=warnings, 2=milestones, 3=every packet event, default off)" << endl;
+  cout << "\t-log_categories LIST\tLog only the comma separated categories among router, disr, pe, net and stats (default all)" << endl;
+  cout << "\t-log_file FILE\tWrite the log to FILE (default standard output)" << endl;
+  cout << "\t-trace FILE\tRecord every router action in the binary trace FILE, see tools/nanoxim_trace" << endl;
+  cout << "\t-checkpoint_at C FILE\tSave the whole simulation state to FILE at cycle C (native engine)" << endl;
+  cout << "\t-fork_server FILE\tElaborate the network once and run in a forked child each line of options read from FILE (e.g. a named pipe)" << endl;
+  cout << "\t-fork_jobs N\tNumber of children the fork server runs at the same time (default " << DEFAULT_FORK_JOBS << ")" << endl;
+  cout << "\t-restore FILE\tResume from the checkpoint FILE, with its mesh, defects and seed (native engine)" << endl;
   cout << "\t-dimx N\t\tSet the mesh X dimension to the specified integer value (default " << DEFAULT_MESH_DIM_X << ")" << endl;
   cout << "\t-dimy N\t\tSet the mesh Y dimension to the specified integer value (default " << DEFAULT_MESH_DIM_Y << ")" << endl;
   cout << "\t-routing TYPE\tSet the routing algorithm to TYPE where TYPE is one of the following (default " << ROUTING_XY << "):" << endl;
-  cout << "\t-sim N\t\tRun for the specified simulation time [cycles] (default " << DEFAULT_SIMULATION_TIME << ")" << endl << endl;
+  cout << "\t-sim N\t\tRun for the specified simulation time [cycles] (default " << DEFAULT_SIMULATION_TIME << ")" << endl;
+  cout << "\t-engine TYPE\tSimulation kernel, where TYPE is systemc or native (default systemc)" << endl;
+  cout << "\t-threads N\tNumber of threads used by the native engine (default " << DEFAULT_THREADS << ")" << endl;
+  cout << "\t-stop_converged\tStop as soon as nothing is in flight and no DiSR timer is running (converged or stalled)" << endl;
+  cout << "\t-stop_coverage X\tStop as soon as node coverage reaches X (0..1)" << endl;
+  cout << "\t-max_wallclock S\tStop after S seconds of wall-clock time" << endl << endl;
   cout << "\t-disr - Run setup for distribuited Segment-base Routing" << endl;
   cout << "\t-bootstrap N - use node N as bootstrap node for Segment-base Routing" << endl;
   cout << "\t-bootstrap_timeout N - used in DiSR Segment-base Routing (default none)" << endl;
@@ -24,52 +38,130 @@ void showHelp(char selfname[])
   cout << "\t-defective_links X - percentage of defective links (0..1) " << endl;
   cout << "\t-defective_nodes X - percentage of defective links (0..1) " << endl;
   cout << "\n-seed N - for randomness (default = time(NULL) " << endl;
+  cout << "\n-runs N - repeat the simulation N times on the same mesh, with seeds S, S+1, ... where S is the -seed one (default 1)" << endl;
+  cout << "\n-seed_list S1,S2,... - repeat the simulation once for each of the listed seeds" << endl;
+  cout << "\n-out FILE - write the results to FILE, appending those of later runs (default: a file named after the parameters, linked by results.txt)" << endl;
   cout << "\n-gv enable output on graphviz (default = no) " << endl;
 }
 
 //---------------------------------------------------------------------------
 
-void showConfig()
+void showConfig(const SimulationParams& params)
 {
   cout << "Using the following configuration: " << endl;
-  cout << "- mesh_dim_x = " << GlobalParams::mesh_dim_x << endl;
-  cout << "- mesh_dim_y = " << GlobalParams::mesh_dim_y << endl;
-  cout << "- buffer_depth = " << GlobalParams::buffer_depth << endl;
-  cout << "- routing_algorithm = " << GlobalParams::routing_algorithm << endl;
-  cout << "- simulation_time = " << GlobalParams::simulation_time << endl;
+  cout << "- mesh_dim_x = " << params.mesh_dim_x << endl;
+  cout << "- mesh_dim_y = " << params.mesh_dim_y << endl;
+  cout << "- buffer_depth = " << params.buffer_depth << endl;
+  cout << "- routing_algorithm = " << params.routing_algorithm << endl;
+  cout << "- simulation_time = " << params.simulation_time << endl;
 }
 
 //---------------------------------------------------------------------------
 
-void checkInputParameters()
+void checkInputParameters(const SimulationParams& params)
 {
-  if (GlobalParams::mesh_dim_x <= 1) {
+  if (params.mesh_dim_x <= 1) {
     cerr << "Error: dimx must be greater than 1" << endl;
     exit(1);
   }
 
-  if (GlobalParams::mesh_dim_y <= 1) {
+  if (params.mesh_dim_y <= 1) {
     cerr << "Error: dimy must be greater than 1" << endl;
     exit(1);
   }
 
-  if (GlobalParams::buffer_depth < 1)
+  if (params.buffer_depth < 1)
   {
     cerr << "Error: buffer must be >= 1" << endl;
     exit(1);
   }
 
+  if (params.threads < 1)
+  {
+    cerr << "Error: threads must be >= 1" << endl;
+    exit(1);
+  }
+
+  if (params.stop_coverage < 0 || params.stop_coverage > 1)
+  {
+    cerr << "Error: stop coverage must be in the range 0..1" << endl;
+    exit(1);
+  }
+
+  if (params.max_wallclock < 0)
+  {
+    cerr << "Error: wall-clock budget must be >= 0" << endl;
+    exit(1);
+  }
+
+  if (params.runs < 1)
+  {
+    cerr << "Error: runs must be >= 1" << endl;
+    exit(1);
+  }
+
+  if (!params.seed_list.empty() && params.runs != (int)params.seed_list.size())
+  {
+    cerr << "Error: runs does not match the number of seeds in the seed list" << endl;
+    exit(1);
+  }
+
+  if (params.threads > 1 && params.engine != ENGINE_NATIVE)
+  {
+    cerr << "Error: multiple threads require the native engine (-engine native)" << endl;
+    exit(1);
+  }
+
+  bool checkpoint = !params.checkpoint_file.empty();
+
+  if (checkpoint && params.checkpoint_cycle <= DEFAULT_RESET_TIME)
+  {
+    cerr << "Error: the checkpoint cycle must be past the reset (" << DEFAULT_RESET_TIME << ")" << endl;
+    exit(1);
+  }
+
+  if ((checkpoint || !params.restore_file.empty()) && params.engine != ENGINE_NATIVE)
+  {
+    cerr << "Error: checkpoints require the native engine (-engine native)" << endl;
+    exit(1);
+  }
+
+  if ((checkpoint || !params.restore_file.empty()) && params.runs > 1)
+  {
+    cerr << "Error: checkpoints are for single runs" << endl;
+    exit(1);
+  }
+
+  if (params.fork_jobs < 1)
+  {
+    cerr << "Error: fork jobs must be >= 1" << endl;
+    exit(1);
+  }
+
+  if (!params.fork_server_file.empty())
+  {
+    // Every request is a run of its own, and the children would all
+    // write the same trace and checkpoint
+    if (params.runs > 1 || !params.trace_file.empty() ||
+	checkpoint || !params.restore_file.empty())
+    {
+      cerr << "Error: the fork server runs one simulation per request, with no trace or checkpoint" << endl;
+      exit(1);
+    }
+  }
+
 }
 
 //---------------------------------------------------------------------------
 
-void parseCmdLine(int arg_num, char *arg_vet[])
+void parseCmdLine(int arg_num, char *arg_vet[], SimulationParams& params)
 {
   if (arg_num == 1)
     cout << "Running with default parameters (use '-help' option to see how to override them)" << endl;
   else
   {
     bool set_boostrap_center = false;
+    bool set_runs = false;
     int tmp_ttl = 0;
 
 
@@ -81,23 +173,69 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	exit(0);
       } 
       else if (!strcmp(arg_vet[i], "-verbose"))
-	GlobalParams::verbose_mode = atoi(arg_vet[++i]);
+	params.verbose_mode = atoi(arg_vet[++i]);
+      else if (!strcmp(arg_vet[i], "-log_categories"))
+      {
+	  i++;
+	  params.log_categories = TLog::parseCategories(arg_vet[i]);
+	  if (params.log_categories < 0)
+	  {
+	      cerr << "Error: Invalid log categories: " << arg_vet[i] << endl;
+	      exit(1);
+	  }
+      }
+      else if (!strcmp(arg_vet[i], "-log_file"))
+	params.log_file = arg_vet[++i];
+      else if (!strcmp(arg_vet[i], "-trace"))
+	params.trace_file = arg_vet[++i];
+      else if (!strcmp(arg_vet[i], "-checkpoint_at"))
+      {
+	params.checkpoint_cycle = atoi(arg_vet[++i]);
+	params.checkpoint_file = arg_vet[++i];
+      }
+      else if (!strcmp(arg_vet[i], "-fork_server"))
+	params.fork_server_file = arg_vet[++i];
+      else if (!strcmp(arg_vet[i], "-fork_jobs"))
+	params.fork_jobs = atoi(arg_vet[++i]);
+      else if (!strcmp(arg_vet[i], "-restore"))
+	params.restore_file = arg_vet[++i];
       else if (!strcmp(arg_vet[i], "-dimx"))
-	GlobalParams::mesh_dim_x = atoi(arg_vet[++i]);
+	params.mesh_dim_x = atoi(arg_vet[++i]);
       else if (!strcmp(arg_vet[i], "-dimy"))
-	GlobalParams::mesh_dim_y = atoi(arg_vet[++i]);
+	params.mesh_dim_y = atoi(arg_vet[++i]);
       else if (!strcmp(arg_vet[i], "-buffer"))
-	GlobalParams::buffer_depth = atoi(arg_vet[++i]);
+	params.buffer_depth = atoi(arg_vet[++i]);
       else if (!strcmp(arg_vet[i], "-routing"))
       {
 	  assert(false);
 	  // currently disabled
-	  GlobalParams::routing_algorithm = ROUTING_XY;
+	  params.routing_algorithm = ROUTING_XY;
       }
       else if (!strcmp(arg_vet[i], "-sim"))
-	GlobalParams::simulation_time = atoi(arg_vet[++i]);
+	params.simulation_time = atoi(arg_vet[++i]);
+      else if (!strcmp(arg_vet[i], "-engine"))
+      {
+	  i++;
+	  if (!strcmp(arg_vet[i], "native"))
+	      params.engine = ENGINE_NATIVE;
+	  else if (!strcmp(arg_vet[i], "systemc"))
+	      params.engine = ENGINE_SYSTEMC;
+	  else
+	  {
+	      cerr << "Error: Invalid engine: " << arg_vet[i] << endl;
+	      exit(1);
+	  }
+      }
+      else if (!strcmp(arg_vet[i], "-threads"))
+	params.threads = atoi(arg_vet[++i]);
+      else if (!strcmp(arg_vet[i], "-stop_converged"))
+	params.stop_converged = 1;
+      else if (!strcmp(arg_vet[i], "-stop_coverage"))
+	params.stop_coverage = atof(arg_vet[++i]);
+      else if (!strcmp(arg_vet[i], "-max_wallclock"))
+	params.max_wallclock = atof(arg_vet[++i]);
       else if (!strcmp(arg_vet[i], "-disr")) 
-	  GlobalParams::disr = 1;
+	  params.disr = 1;
       else if (!strcmp(arg_vet[i], "-bootstrap"))
       {
 	  // note that dimx and y should be set before in the command
@@ -107,25 +245,40 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	      set_boostrap_center = true;
 	  }
 	  else
-	    GlobalParams::bootstrap = atoi(arg_vet[i+1]);
+	    params.bootstrap = atoi(arg_vet[i+1]);
 	  i++;
       }
       else if (!strcmp(arg_vet[i], "-bootstrap_timeout"))
-	GlobalParams::bootstrap_timeout = atoi(arg_vet[++i]);
+	params.bootstrap_timeout = atoi(arg_vet[++i]);
       else if (!strcmp(arg_vet[i], "-ttl"))
 	tmp_ttl = atoi(arg_vet[++i]);
       else if (!strcmp(arg_vet[i], "-bootstrap_immunity"))
-	GlobalParams::bootstrap_immunity = 1;
+	params.bootstrap_immunity = 1;
       else if (!strcmp(arg_vet[i], "-gv"))
-	GlobalParams::graphviz = 1;
+	params.graphviz = 1;
       else if (!strcmp(arg_vet[i], "-cyclelinks"))
-	GlobalParams::cyclelinks = atoi(arg_vet[++i]); 
+	params.cyclelinks = atoi(arg_vet[++i]); 
       else if (!strcmp(arg_vet[i], "-defective_links"))
-	GlobalParams::defective_links = atof(arg_vet[++i]); 
+	params.defective_links = atof(arg_vet[++i]); 
       else if (!strcmp(arg_vet[i], "-defective_nodes"))
-	GlobalParams::defective_nodes = atof(arg_vet[++i]); 
+	params.defective_nodes = atof(arg_vet[++i]); 
       else if (!strcmp(arg_vet[i], "-seed"))
-	GlobalParams::rnd_generator_seed = atoi(arg_vet[++i]); 
+	params.rnd_generator_seed = atoi(arg_vet[++i]); 
+      else if (!strcmp(arg_vet[i], "-runs"))
+      {
+	params.runs = atoi(arg_vet[++i]); 
+	set_runs = true;
+      }
+      else if (!strcmp(arg_vet[i], "-out"))
+	params.output_file = arg_vet[++i];
+      else if (!strcmp(arg_vet[i], "-seed_list"))
+      {
+	  istringstream iss(arg_vet[++i]);
+	  string seed;
+
+	  while (getline(iss, seed, ','))
+	      params.seed_list.push_back(atoi(seed.c_str()));
+      }
       else 
       {
 	cerr << "Error: Invalid option: " << arg_vet[i] << endl;
@@ -134,15 +287,18 @@ void parseCmdLine(int arg_num, char *arg_vet[])
     }
     
     if (set_boostrap_center)
-	    GlobalParams::bootstrap = (GlobalParams::mesh_dim_y/2)*GlobalParams::mesh_dim_x+GlobalParams::mesh_dim_x/2;
+	    params.bootstrap = (params.mesh_dim_y/2)*params.mesh_dim_x+params.mesh_dim_x/2;
+
+    if (!set_runs && !params.seed_list.empty())
+	params.runs = params.seed_list.size();
 
     if (tmp_ttl)
-	GlobalParams::ttl = tmp_ttl;
+	params.ttl = tmp_ttl;
     else
-	GlobalParams::ttl = GlobalParams::mesh_dim_x;
+	params.ttl = params.mesh_dim_x;
   }
 
-  checkInputParameters();
+  checkInputParameters(params);
 
 }
 
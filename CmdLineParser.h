@@ -3,11 +3,13 @@
 
 //---------------------------------------------------------------------------
 
+#include "nanoxim.h"
+
 using namespace std;
 
 //---------------------------------------------------------------------------
 
-void parseCmdLine(int arg_num, char *arg_vet[]);
+void parseCmdLine(int arg_num, char *arg_vet[], SimulationParams& params);
 
 //---------------------------------------------------------------------------
 
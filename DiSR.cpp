@@ -7,22 +7,18 @@
 *****************************************************************************/
 #include "nanoxim.h"
 #include "TRouter.h"
+#include "SimulationContext.h"
+#include "TCheckpoint.h"
 
 //---------------------------------------------------------------------------
 
-TSegmentId::TSegmentId()
-{
-    this->node = NOT_RESERVED;
-    this->link = NOT_RESERVED;
-}
-
 void DiSR::set_router(TRouter * r)
 {
     this->router = r;
     // To test the model, the node 0 is always used for bootstrapping 
     // the whole algorithm
     // Whener the router pointer is updated, status must be resetted
-    if (r->local_id == GlobalParams::bootstrap) 
+    if (r->local_id == router->ctx->params.bootstrap) 
 	setStatus(BOOTSTRAP);
     else
 	setStatus(FREE);
@@ -36,7 +32,7 @@ DiSR_status DiSR::getStatus() const
     // sanity check of some assumed environmnet values
     switch (this->status) {
 	case BOOTSTRAP:
-	    assert(this->router->local_id == GlobalParams::bootstrap);
+	    assert(this->router->local_id == router->ctx->params.bootstrap);
 	    assert(tvisited==false);
 	    assert(visited==false);
 	    break;
@@ -56,12 +52,12 @@ DiSR_status DiSR::getStatus() const
 	    break;
 	case FREE:
 	    if (tvisited)
-		cout << "[node " <<router->local_id<< "] DiSR::getStatus()  FREE with tvisited" << this->status << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node " <<router->local_id<< "] DiSR::getStatus()  FREE with tvisited" << this->status;
 	    assert(tvisited==false);
 	    assert(visited==false);
 	    break;
 	default:
-	    cout << "[node " <<router->local_id<< "] DiSR::getStatus()  WARNING not valid status " << this->status << endl;
+	    cerr << "[node " <<router->local_id<< "] DiSR::getStatus()  WARNING not valid status " << this->status << endl;
 	    assert(false);
     }
 
@@ -81,7 +77,7 @@ void DiSR::setStatus(const DiSR_status& new_status)
     //assert(new_status!=current_status);
     
     if (new_status==current_status)
-	    cout << "[node "<<router->local_id<< "] DiSR::setStatus()  WARNING: setting already present status "<< current_status << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_WARNING) << "[node "<<router->local_id<< "] DiSR::setStatus()  WARNING: setting already present status "<< current_status;
 
 
     switch (new_status) {
@@ -95,28 +91,32 @@ void DiSR::setStatus(const DiSR_status& new_status)
 	case CANDIDATE:
 	    break;
 	case ASSIGNED:
-	    this->assign_timestamp = sc_time_stamp().to_double()/1000;
+	    this->assign_timestamp = router->ctx->getCurrentCycle();
 	    break;
 	case FREE:
 	    break;
 	default:
-	    cout << "[node " <<router->local_id<<"] DiSR::setStatus() CRITICAL: setting not valid status " << new_status << endl;
+	    cerr << "[node " <<router->local_id<<"] DiSR::setStatus() CRITICAL: setting not valid status " << new_status << endl;
 	    assert(false);
     }
     this->status = new_status;
 }
 
 
-void DiSR::setLinks(int type, const vector<int>& directions,const TSegmentId& id)
+// directions is a bitmask of DIRECTION_BIT()
+void DiSR::setLinks(int type, const unsigned int directions,const TSegmentId& id)
 {
 
-    for (unsigned int i = 0;i<directions.size();i++)
+    for (int i = 0;i<DIRECTIONS;i++)
     {
+	if (!(directions & DIRECTION_BIT(i)))
+	    continue;
+
 	if (type==TVISITED)
-	    link_tvisited[directions[i]] = id;
+	    link_tvisited[i] = id;
 
 	if (type==VISITED)
-	    link_visited[directions[i]] = id;
+	    link_visited[i] = id;
     }
 }
 
@@ -145,7 +145,7 @@ int DiSR::process(TPacket& p)
     ////////////////////////////////////////////////////////
     {
 
-	cout << "[node "<<router->local_id << "] DiSR::process() found STARTING_SEGMENT_REQUEST " << packet_segment_id << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() found STARTING_SEGMENT_REQUEST " << packet_segment_id;
 
 	 // locally generated // //////////////////////////////////////////////////
 	if ( (p.src_id==router->local_id) && (p.dir_in==DIRECTION_LOCAL) )
@@ -176,7 +176,7 @@ int DiSR::process(TPacket& p)
 			// since link LED has been updated:
 			reset_cyclelinks();
 
-			cout << "[node "<<router->local_id<<"] DiSR::process() confirming STARTING_SEGMENT_REQUEST " << packet_segment_id << endl;
+			LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::process() confirming STARTING_SEGMENT_REQUEST " << packet_segment_id;
 			setStatus(ASSIGNED);
 
 
@@ -186,12 +186,12 @@ int DiSR::process(TPacket& p)
 		}
 		// if we are here, no tvisited link was associated to the request
 
-		cout << "[node "<< router->local_id <<  "] DiSR::process() discarding deprecated STARTING_SEGMENT_REQUEST " << packet_segment_id << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() discarding deprecated STARTING_SEGMENT_REQUEST " << packet_segment_id;
 		return ACTION_DISCARD;
 	    }
 	    else // starting segment with segID already confirmed...
 	    {
-		cout << "[node "<< router->local_id <<  "] DiSR::process() discarding already confirmed STARTING_SEGMENT_REQUEST " << packet_segment_id << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() discarding already confirmed STARTING_SEGMENT_REQUEST " << packet_segment_id;
 		return ACTION_DISCARD;
 	    }
 	    
@@ -204,7 +204,7 @@ int DiSR::process(TPacket& p)
 	    if (this->getStatus()==FREE)
 	    {
 #ifdef VERBOSE
-		cout << "[node "<<router->local_id << "] DiSR::process() enable ACTION_FLOOD" << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() enable ACTION_FLOOD";
 #endif
 
 		this->segID = packet_segment_id;
@@ -224,7 +224,7 @@ int DiSR::process(TPacket& p)
 	    {
 		if ( this->segID.getLink()<packet_segment_id.getLink())
 		{
-		    cout << "[node "<<router->local_id << "] DiSR::process() WARNING: new STARTING_SEGMENT_REQUEST " << packet_segment_id << " overwrites deprecated  " << this->segID << ", enable ACTION_FLOOD" << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_WARNING) << "[node "<<router->local_id << "] DiSR::process() WARNING: new STARTING_SEGMENT_REQUEST " << packet_segment_id << " overwrites deprecated  " << this->segID << ", enable ACTION_FLOOD";
 		    // reset the previous LED data
 		    for (int i=0;i<DIRECTIONS;i++)
 		    {
@@ -252,7 +252,7 @@ int DiSR::process(TPacket& p)
 		}
 		else
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() already candidate " << this->segID << " discarding STARTING_SEGMENT_REQUEST  " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() already candidate " << this->segID << " discarding STARTING_SEGMENT_REQUEST  " << packet_segment_id;
 		    print_status();
 		    return ACTION_DISCARD;
 		}
@@ -263,7 +263,7 @@ int DiSR::process(TPacket& p)
 	    else
 	    {
 		print_status();
-		cout << "[node "<< router->local_id <<  "] DiSR::process() discarding flooding " << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() discarding flooding ";
 		return ACTION_DISCARD;
 	    }
 	    
@@ -275,7 +275,7 @@ int DiSR::process(TPacket& p)
     else if (p.type == SEGMENT_REQUEST)
     ////////////////////////////////////////////////////////
     {
-	cout << "[node "<<router->local_id << "] DiSR::process() found SEGMENT_REQUEST with ID " << packet_segment_id << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() found SEGMENT_REQUEST with ID " << packet_segment_id;
 
 	// present in the local buffer, not necessarily locally
 	// generate (e.g. when occurring ACTION_RETRY_REQUEST)
@@ -308,7 +308,7 @@ int DiSR::process(TPacket& p)
 
 		    link_tvisited[freedirection] = packet_segment_id;
 
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() setting CANDIDATE id " << this->segID << " forwarding to " << freedirection <<endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() setting CANDIDATE id " << this->segID << " forwarding to " << freedirection;
 		    this->setStatus(CANDIDATE);
 		    set_request_path(p.dir_in); // future confirm packet will be forwarded along this direction 
 		    // TODO: more consistenly update this value, (e.g.  // currently updated also in ACTION_FLOOD of // TRouter...)
@@ -316,14 +316,14 @@ int DiSR::process(TPacket& p)
 		}
 		else if (freedirection == CYCLE_TIMEOUT)
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), CYCLE_TIMEOUT, cancelling SEGMENT_REQUEST id " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), CYCLE_TIMEOUT, cancelling SEGMENT_REQUEST id " << packet_segment_id;
 		    free_direction(p.dir_in);
 		    generate_segment_cancel(p);
 		    return ACTION_CANCEL_REQUEST;
 		}
 		else if (freedirection == NO_LINK)
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), re-processing SEGMENT_REQUEST id at next cycle " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), re-processing SEGMENT_REQUEST id at next cycle " << packet_segment_id;
 		    return ACTION_SKIP;
 		}
 		else
@@ -342,7 +342,7 @@ int DiSR::process(TPacket& p)
 	    // formed, so the segment request should not interrupt this process! */
 	    else if (this->getStatus()==CANDIDATE_STARTING) 
 	    {
-		cout << "[node "<< router->local_id <<  "] DiSR::process() cancelling previous CANDIDATE_STARTING " << this->segID << " due SEGMENT_REQUEST with id " << packet_segment_id << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() cancelling previous CANDIDATE_STARTING " << this->segID << " due SEGMENT_REQUEST with id " << packet_segment_id;
 		// reset the previous LED data
 		for (int i=0;i<DIRECTIONS;i++)
 		{
@@ -367,7 +367,7 @@ int DiSR::process(TPacket& p)
 
 		if ( (freedirection>=0) && (freedirection<DIRECTION_LOCAL) )
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() setting CANDIDATE with id " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() setting CANDIDATE with id " << packet_segment_id;
 		    this->segID = packet_segment_id;
 		    this->tvisited = true;
 		    this->visited = false;
@@ -380,7 +380,7 @@ int DiSR::process(TPacket& p)
 		}
 		else if (freedirection==CYCLE_TIMEOUT)
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), CYCLE_TIMEOUT, cancelling SEGMENT_REQUEST id " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), CYCLE_TIMEOUT, cancelling SEGMENT_REQUEST id " << packet_segment_id;
 		    // This can happen when defective links are present
 		    free_direction(p.dir_in);
 		    generate_segment_cancel(p);
@@ -388,7 +388,7 @@ int DiSR::process(TPacket& p)
 		}
 		else if (freedirection==NO_LINK)
 		{
-		    cout << "WARNING [node "<< router->local_id <<  "] DiSR::process() no free link after cancelling a CANDIDATE_STARTING " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_WARNING) << "WARNING [node "<< router->local_id <<  "] DiSR::process() no free link after cancelling a CANDIDATE_STARTING " << packet_segment_id;
 		    free_direction(p.dir_in);
 		    generate_segment_cancel(p);
 		    return ACTION_CANCEL_REQUEST;
@@ -407,7 +407,7 @@ int DiSR::process(TPacket& p)
 		link_tvisited[p.dir_in].set(NOT_RESERVED,NOT_RESERVED);
 		generate_segment_confirm(p);
 		this->set_request_path(p.dir_in); // future confirm packet will be forwarded along this direction 
-		cout << "[node "<<router->local_id<<"] DiSR::process() confirming SEGMENT_REQUEST " << packet_segment_id << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::process() confirming SEGMENT_REQUEST " << packet_segment_id;
 		return ACTION_CONFIRM;
 
 	    }
@@ -421,7 +421,7 @@ int DiSR::process(TPacket& p)
 		link_tvisited[p.dir_in].set(NOT_RESERVED,NOT_RESERVED);
 		generate_segment_confirm(p);
 		this->set_request_path(p.dir_in); // future confirm packet will be forwarded along this direction 
-		cout << "[node "<<router->local_id<<"] DiSR::process() confirming SEGMENT_REQUEST " << packet_segment_id << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::process() confirming SEGMENT_REQUEST " << packet_segment_id;
 		return ACTION_CONFIRM;
 
 	    }
@@ -431,7 +431,7 @@ int DiSR::process(TPacket& p)
 		// trivial case: candidate with different id, must cancel request
 		if (!(this->segID==packet_segment_id))
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() already CANDIDATE with id " << this->segID << ", cancelling request "<< packet_segment_id << " from " << p.dir_in << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() already CANDIDATE with id " << this->segID << ", cancelling request "<< packet_segment_id << " from " << (int)p.dir_in;
 		    free_direction(p.dir_in);
 		    generate_segment_cancel(p);
 		    // the incoming direction becomes free
@@ -444,9 +444,9 @@ int DiSR::process(TPacket& p)
 		else 
 		{
 		    assert(p.dir_in!=DIRECTION_LOCAL);
-		    cout << "[node "<< router->local_id <<  "] WARNING: already processed SEGMENT_REQUEST  " << packet_segment_id << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_WARNING) << "[node "<< router->local_id <<  "] WARNING: already processed SEGMENT_REQUEST  " << packet_segment_id;
 //#ifdef VERBOSE
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() dir_in= " << p.dir_in << " dir_out = " << p.dir_out << " request_path= " << request_path << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() dir_in= " << (int)p.dir_in << " dir_out = " << (int)p.dir_out << " request_path= " << request_path;
 //#endif
 
 		    // yeah, it was waiting for ABP, since the following condition means that 
@@ -459,18 +459,18 @@ int DiSR::process(TPacket& p)
 			    // note that we should avoid the incoming request path, which is also tvisited
 			    if (link_tvisited[i] == packet_segment_id &&  (i!=request_path))
 			    {
-				cout << "[node "<< router->local_id <<  "] DiSR::process() re-trying processed SEGMENT_REQUEST  " << packet_segment_id << " along DIR " << i << endl;
+				LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() re-trying processed SEGMENT_REQUEST  " << packet_segment_id << " along DIR " << i;
 				return i;
 			    }
 			}
 			// something strange happened...
-			cout << "[node "<< router->local_id <<  "] DiSR::process() CRITICAL: no tvisited link for already processed SEGMENT_REQUEST  "<< packet_segment_id << " from " << p.dir_in << endl;
+			cerr << "[node "<< router->local_id <<  "] DiSR::process() CRITICAL: no tvisited link for already processed SEGMENT_REQUEST  "<< packet_segment_id << " from " << (int)p.dir_in << endl;
 			assert(false);
 
 		    }
 
 		    // no, the packet is just coming from a different direction with the same id
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() already CANDIDATE with same id " << this->segID << ", cancelling request "<< packet_segment_id << " from " << p.dir_in << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() already CANDIDATE with same id " << this->segID << ", cancelling request "<< packet_segment_id << " from " << (int)p.dir_in;
 		    free_direction(p.dir_in);
 		    generate_segment_cancel(p);
 		    return ACTION_CANCEL_REQUEST;
@@ -480,7 +480,7 @@ int DiSR::process(TPacket& p)
 	    else
 	    {
 		// TODO: catch any remainig case
-		cout << "[node "<< router->local_id <<  "] DiSR::process() CRITICAL, unsupported status" << this->getStatus() << endl;
+		cerr << "[node "<< router->local_id <<  "] DiSR::process() CRITICAL, unsupported status" << this->getStatus() << endl;
 		print_status();
 		assert(false);
 		return NOT_VALID;
@@ -498,7 +498,7 @@ int DiSR::process(TPacket& p)
 	    link_tvisited[p.dir_in].set(NOT_RESERVED,NOT_RESERVED);
 	    generate_segment_confirm(p);
 	    this->set_request_path(p.dir_in); // future confirm packet will be forwarded along this direction 
-	    cout << "[node "<<router->local_id<<"] DiSR::process() confirming SEGMENT_REQUEST " << packet_segment_id << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::process() confirming SEGMENT_REQUEST " << packet_segment_id;
 	    return ACTION_CONFIRM;
 
 	}
@@ -510,12 +510,12 @@ int DiSR::process(TPacket& p)
     ////////////////////////////////////////////////////////
     {
 
-	cout << "[node "<<router->local_id << "] DiSR::process() processing STARTING_SEGMENT_CONFIRM with ID " << packet_segment_id << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() processing STARTING_SEGMENT_CONFIRM with ID " << packet_segment_id;
 
 	 // locally generated starting segment packet confirmation, 
 	if ( (p.src_id==router->local_id) && (p.dir_in==DIRECTION_LOCAL) )
 	{
-	    cout << "[node "<<router->local_id << "] DiSR::process() sending locally generated STARTING_SEGMENT_CONFIRM with id " << packet_segment_id << " towards " << p.dir_out << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() sending locally generated STARTING_SEGMENT_CONFIRM with id " << packet_segment_id << " towards " << (int)p.dir_out;
 	     // inject the packet to the appropriate link previously found by generate_segment_confirm()
 	    return p.dir_out;
 	}
@@ -525,7 +525,7 @@ int DiSR::process(TPacket& p)
 
 	    if  ( (this->getStatus()==CANDIDATE_STARTING) && (local_segment_id == packet_segment_id) )
 	    {
-		cout << "[node "<< router->local_id <<  "] DiSR::process()  CANDIDATE_STARTING to segment id: " << local_segment_id << " has been **ASSIGNED!**" << endl;
+		LOG(router->ctx, LOG_DISR, LOG_INFO) << "[node "<< router->local_id <<  "] DiSR::process()  CANDIDATE_STARTING to segment id: " << local_segment_id << " has been **ASSIGNED!**";
 		// node status changes from tvisited to visited
 		this->tvisited = false;
 		this->visited = true;
@@ -560,15 +560,15 @@ int DiSR::process(TPacket& p)
 		// TODO: deprecated ? this->release_forwarding_paths();
 
 		this->setStatus(ASSIGNED);
-		cout << "[node "<< router->local_id <<  "] DiSR::process()  forwarding STARTING_SEGMENT_CONFIRM " << packet_segment_id << " back to " << this->request_path << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process()  forwarding STARTING_SEGMENT_CONFIRM " << packet_segment_id << " back to " << this->request_path;
 		return this->request_path;
 		
 		// return FORWARD_CONFIRM;
 	    }
 	    else 
 	    {
-		cout << "[node "<<router->local_id << "] DiSR::process()  CRITICAL, receving STARTING_SEGMENT_CONFIRM with inconsistent environment:" << endl;
-		cout << "[node "<<router->local_id << "] DiSR::process()  local segid = " << local_segment_id << " , packet id = " << packet_segment_id << ", ";
+		cerr << "[node "<<router->local_id << "] DiSR::process()  CRITICAL, receving STARTING_SEGMENT_CONFIRM with inconsistent environment:" << endl;
+		cerr << "[node "<<router->local_id << "] DiSR::process()  local segid = " << local_segment_id << " , packet id = " << packet_segment_id << ", ";
 		print_status();
 		assert(false);
 		return ACTION_SKIP;
@@ -579,7 +579,7 @@ int DiSR::process(TPacket& p)
 	else // the confirmation packet returned to its orginal source, all done!
 	if ( (p.src_id==router->local_id) && (p.dir_in!=DIRECTION_LOCAL) )
 	{
-	    cout << "[node "<<router->local_id<<"] DiSR::process()  STARTING_SEGMENT_CONFIRM id " << packet_segment_id <<  " ended !" << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_INFO) << "[node "<<router->local_id<<"] DiSR::process()  STARTING_SEGMENT_CONFIRM id " << packet_segment_id <<  " ended !";
 	    // Note: status has already set to ASSIGNED when ACTION_CONFIRM was issued
 	    // Setting again as ASSIGNED would overwrite any ACTIVE_SEARCHING status, thus making
 	    // start_investigate_links() function to inject another segment request without waiting
@@ -602,13 +602,13 @@ int DiSR::process(TPacket& p)
     else if (p.type == SEGMENT_CONFIRM)
     ////////////////////////////////////////////////////////
     {
-	cout << "[node "<<router->local_id << "] DiSR::process() processing SEGMENT_CONFIRM with ID " << packet_segment_id << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() processing SEGMENT_CONFIRM with ID " << packet_segment_id;
 
 	//////////////////////////////////////////////////////
 	 // just generated locally
 	if ( (p.src_id==router->local_id) && (p.dir_in==DIRECTION_LOCAL) )
 	{
-	    cout << "[node "<<router->local_id << "] DiSR::process() sending locally generated SEGMENT_CONFIRM with id " << packet_segment_id << " towards " << p.dir_out << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() sending locally generated SEGMENT_CONFIRM with id " << packet_segment_id << " towards " << (int)p.dir_out;
 	     // inject the packet to the appropriate link previously found by generate_segment_confirm()
 	    return p.dir_out;
 	}
@@ -616,7 +616,7 @@ int DiSR::process(TPacket& p)
 	// the confirmation packet returned to segment initiator, all done!
 	if ( (packet_segment_id.getNode()==router->local_id) )
 	{
-	    cout << "[node "<<router->local_id<<"] DiSR::process()  SEGMENT_CONFIRM id " << packet_segment_id <<  " ended !" << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_INFO) << "[node "<<router->local_id<<"] DiSR::process()  SEGMENT_CONFIRM id " << packet_segment_id <<  " ended !";
 
 	    // the incoming link changes from tvsited to visited with the segment id
 	    this->link_visited[p.dir_in] = packet_segment_id;
@@ -630,7 +630,7 @@ int DiSR::process(TPacket& p)
 	if  ( (this->getStatus()==CANDIDATE) && (local_segment_id == packet_segment_id) )
 	{
 
-	    cout << "[node "<< router->local_id <<  "] DiSR::process()  CANDIDATE to segment id: " << local_segment_id << " has been **ASSIGNED!**" << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_INFO) << "[node "<< router->local_id <<  "] DiSR::process()  CANDIDATE to segment id: " << local_segment_id << " has been **ASSIGNED!**";
 	    setStatus(ASSIGNED);
 
 	    // node status changes from tvisited to visited
@@ -644,13 +644,13 @@ int DiSR::process(TPacket& p)
 	    this->link_visited[this->request_path] = packet_segment_id;
 	    this->link_tvisited[this->request_path].set(NOT_RESERVED,NOT_RESERVED);
 
-	    cout << "[node "<< router->local_id <<  "] DiSR::process()  forwarding  SEGMENT_CONFIRM " << packet_segment_id << " back to " << this->request_path << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process()  forwarding  SEGMENT_CONFIRM " << packet_segment_id << " back to " << this->request_path;
 	    return this->request_path;
 	    
 	}
 
-	cout << "[node "<<router->local_id << "] DiSR::process()  CRITICAL, receving SEGMENT_CONFIRM with inconsistent environment:" << endl;
-	cout << "[node "<<router->local_id << "] DiSR::process()  local segid = " << local_segment_id << " , packet id = " << packet_segment_id << ", ";
+	cerr << "[node "<<router->local_id << "] DiSR::process()  CRITICAL, receving SEGMENT_CONFIRM with inconsistent environment:" << endl;
+	cerr << "[node "<<router->local_id << "] DiSR::process()  local segid = " << local_segment_id << " , packet id = " << packet_segment_id << ", ";
 	print_status();
 	assert(false);
 	return ACTION_SKIP;
@@ -661,12 +661,12 @@ int DiSR::process(TPacket& p)
     else if (p.type == SEGMENT_CANCEL)
     ////////////////////////////////////////////////////////
     {
-	cout << "[node "<<router->local_id << "] DiSR::process() processing SEGMENT_CANCEL " << packet_segment_id << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() processing SEGMENT_CANCEL " << packet_segment_id;
 
 	 // locally generated segment packet cancel, 
 	if ( (p.src_id==router->local_id) && (p.dir_in==DIRECTION_LOCAL) )
 	{
-	    cout << "[node "<<router->local_id << "] DiSR::process() sending locally generated SEGMENT_CANCEL " << packet_segment_id << " towards " << p.dir_out << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id << "] DiSR::process() sending locally generated SEGMENT_CANCEL " << packet_segment_id << " towards " << (int)p.dir_out;
 	     // inject the packet to the appropriate link previously found by generate_segment_cancel()
 	    return p.dir_out;
 	}
@@ -677,7 +677,7 @@ int DiSR::process(TPacket& p)
 	    // request should be forwarded back (until initial node)
 	    if (!p.ttl)
 	    {
-		cout << "[node "<< router->local_id <<  "] DiSR::process(), TTL ZERO for request " << packet_segment_id  << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), TTL ZERO for request " << packet_segment_id;
 
 		// current node was not the initiator of the request
 		// so the cancel packet should be forwarded back 
@@ -694,13 +694,13 @@ int DiSR::process(TPacket& p)
 		    // node status changes from tvisited to free
 		    this->tvisited = false;
 		    this->setStatus(FREE);
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), forwarding SEGMENT_CANCEL " << packet_segment_id << " back to " << this->request_path << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), forwarding SEGMENT_CANCEL " << packet_segment_id << " back to " << this->request_path;
 		    // is it not necessary to use generate_segment_cancel(), since we already have a cancel packet
 		    return this->request_path;
 		}
 		else
 		{
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), ending segment request " << packet_segment_id << " on initiator" << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), ending segment request " << packet_segment_id << " on initiator";
 		}
 
 	    }
@@ -742,14 +742,14 @@ int DiSR::process(TPacket& p)
 		{
 		    // update id and ttl field for new request
 		    packet_segment_id.set(this->router->local_id,new_direction);
-		    packet.ttl = GlobalParams::ttl;
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() Trying new SEGMENT_REQUEST " << packet_segment_id << " (ttl " << packet.ttl << " ) along " << new_direction <<endl;
+		    packet.ttl = router->ctx->params.ttl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() Trying new SEGMENT_REQUEST " << packet_segment_id << " (ttl " << packet.ttl << " ) along " << new_direction;
 		}
 		else
 		{
 		    // continue using old ttl
 		    packet.ttl = p.ttl;
-		    cout << "[node "<< router->local_id <<  "] DiSR::process() Retrying SEGMENT_REQUEST " << packet_segment_id << " (ttl " << packet.ttl << " ) along " << new_direction <<endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process() Retrying SEGMENT_REQUEST " << packet_segment_id << " (ttl " << packet.ttl << " ) along " << new_direction;
 		}
 
 		packet.id = packet_segment_id;
@@ -762,7 +762,7 @@ int DiSR::process(TPacket& p)
 	    }
 	    else if (new_direction==CYCLE_TIMEOUT) // link investigation should be stopped
 	    {
-		cout << "[node "<< router->local_id <<  "] DiSR::process(), CYCLE_TIMEOUT for SEGMENT_REQUEST " << packet_segment_id  << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), CYCLE_TIMEOUT for SEGMENT_REQUEST " << packet_segment_id;
 
 		// if the initial request started from here:
 		//  - no need  to forward the segment cancel 
@@ -773,7 +773,7 @@ int DiSR::process(TPacket& p)
 		    assert(this->visited);
 		    assert(!(this->tvisited));
 
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), ending segment request process " << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), ending segment request process ";
 		    return ACTION_END_CANCEL;
 		}
 		else
@@ -788,7 +788,7 @@ int DiSR::process(TPacket& p)
 		    // node status changes from tvisited to free
 		    this->tvisited = false;
 		    this->setStatus(FREE);
-		    cout << "[node "<< router->local_id <<  "] DiSR::process(), forwarding SEGMENT_CANCEL " << packet_segment_id << " back to " << this->request_path << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), forwarding SEGMENT_CANCEL " << packet_segment_id << " back to " << this->request_path;
 		    // is it not necessary to use generate_segment_cancel(), since we already have a cancel packet
 		    return this->request_path;
 		}
@@ -799,12 +799,12 @@ int DiSR::process(TPacket& p)
 		assert(false);
 		reset_cyclelinks();
 
-		//cout << "[node "<< router->local_id <<  "] DiSR::process()  freeing request path " << this->request_path << " and incoming dir " << p.dir_in << endl;
+		//cout << "[node "<< router->local_id <<  "] DiSR::process()  freeing request path " << this->request_path << " and incoming dir " << (int)p.dir_in << endl;
 		//cout << "[node "<< router->local_id <<  "] DiSR::process()  current_link = " << this->current_link << endl;
 	    }
 	    else if (new_direction==NO_LINK)
 	    {
-		cout << "[node "<< router->local_id <<  "] DiSR::process(), re-processing SEGMENT_CANCEL id " << packet_segment_id << " at next cycle " << endl;
+		LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<< router->local_id <<  "] DiSR::process(), re-processing SEGMENT_CANCEL id " << packet_segment_id << " at next cycle ";
 		return ACTION_SKIP;
 	    }
 	    
@@ -820,7 +820,7 @@ int DiSR::process(TPacket& p)
 void DiSR::set_request_path(int path)
 {
 #ifdef VERBOSE
-    cout << "[node "<<router->local_id<<"] DiSR::set_request_path() to " << path <<  endl;
+    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::set_request_path() to " << path;
 #endif
     this->request_path = path;
 }
@@ -828,11 +828,11 @@ void DiSR::set_request_path(int path)
 
 void DiSR::reset_cyclelinks()
 {
-    this->cyclelinks_timeout = GlobalParams::cyclelinks;
+    this->cyclelinks_timeout = router->ctx->params.cyclelinks;
     this->cycle_start = 0;
     this->current_link = 0;
 #ifdef VERBOSE
-    cout << "[node "<<router->local_id<<"] DiSR::reset_cyclelinks() setting cycle_start =  " << current_link << endl;
+    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::reset_cyclelinks() setting cycle_start =  " << current_link;
 #endif
 }
 
@@ -844,7 +844,7 @@ int DiSR::next_free_link()
 	//cout << "[DiSR::next_free_link() on  "<<router->local_id<<"] re-starting cycle... " << current_link << endl;
 	current_link=DIRECTION_NORTH;
     }
-    cout << "[node "<<router->local_id<<"] DiSR::next_free_link() cycle_start = " << cycle_start << ", current_link = "<<current_link << endl;
+    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::next_free_link() cycle_start = " << cycle_start << ", current_link = "<<current_link;
 
     // new Semantic:
     //
@@ -858,7 +858,7 @@ int DiSR::next_free_link()
 
     if (this->cyclelinks_timeout==0)
     {
-	cout << "[node "<<router->local_id<<"] DiSR::next_free_link() CYCLE_TIMEOUT " << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::next_free_link() CYCLE_TIMEOUT ";
 	reset_cyclelinks();
 	return CYCLE_TIMEOUT;
     }
@@ -866,7 +866,7 @@ int DiSR::next_free_link()
     while (!stop)
     {
 #ifdef VERBOSE
-	cout << "[node "<<router->local_id<<"] DiSR::next_free_link() analyzing direction " << current_link << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::next_free_link() analyzing direction " << current_link;
 #endif
 
 	if ( (link_visited[current_link].isFree()) && (link_tvisited[current_link].isFree()))
@@ -886,13 +886,14 @@ int DiSR::next_free_link()
 	if (current_link==cycle_start)
 	{
 	    this->cyclelinks_timeout--;
-	    cout << "[node "<<router->local_id<<"] DiSR::next_free_link() completed cycle at next dir " << current_link << ", timeout "<<cyclelinks_timeout<<"/"<<GlobalParams::cyclelinks<<endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::next_free_link() completed cycle at next dir " << current_link << ", timeout "<<cyclelinks_timeout<<"/"<<router->ctx->params.cyclelinks;
 	    stop = true;
 	} 
     }
-    if (found_dir==NO_LINK) cout << "no link found! " << endl;
+    if (found_dir==NO_LINK)
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "no link found! ";
     else
-	cout << " found dir " << found_dir << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << " found dir " << found_dir;
 
     return found_dir;
 }
@@ -911,14 +912,14 @@ bool DiSR::has_free_link() const
     while (!stop)
     {
 #ifdef VERBOSE
-	cout << "[node "<<router->local_id<<"] DiSR::has_free_link() analyzing direction " << tmp_link << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::has_free_link() analyzing direction " << tmp_link;
 #endif
 
 
 	if ( (link_visited[tmp_link].isFree()) && (link_tvisited[tmp_link].isFree()))
 	{
 #ifdef VERBOSE
-	    cout << "found free link " << tmp_link <<  endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "found free link " << tmp_link;
 #endif
 
 	    return true;
@@ -930,7 +931,7 @@ bool DiSR::has_free_link() const
 	if (tmp_link==start) stop = true;
     }
 #ifdef VERBOSE
-    cout << "no link found! " << endl;
+    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "no link found! ";
 #endif
 
     return false;
@@ -943,32 +944,32 @@ void DiSR::print_status() const
     {
 	switch (this->status) {
 	    case BOOTSTRAP:
-		cout << "[node "<<router->local_id<<"] DBS status:  BOOTSTRAP" << endl;
+		cerr << "[node "<<router->local_id<<"] DBS status:  BOOTSTRAP" << endl;
 		break;
 	    case ACTIVE_SEARCHING:
-		cout << "[node "<<router->local_id<<"] DBS status:  ACTIVE_SEARCHING" << endl;
+		cerr << "[node "<<router->local_id<<"] DBS status:  ACTIVE_SEARCHING" << endl;
 		break;
 	    case CANDIDATE:
-		cout << "[node "<<router->local_id<<"] DBS status:  CANDIDATE" << endl;
+		cerr << "[node "<<router->local_id<<"] DBS status:  CANDIDATE" << endl;
 		break;
 	    case CANDIDATE_STARTING:
-		cout << "[node "<<router->local_id<<"] DBS status:  CANDIDATE_STARTING" << endl;
+		cerr << "[node "<<router->local_id<<"] DBS status:  CANDIDATE_STARTING" << endl;
 		break;
 	    case ASSIGNED:
-		cout << "[node "<<router->local_id<<"] DBS status:  ASSIGNED" << endl;
+		cerr << "[node "<<router->local_id<<"] DBS status:  ASSIGNED" << endl;
 		break;
 	    case FREE:
 		// assuming mute as free
 		// cout << "[DiSR on "<<router->local_id<<"] status:  FREE" << endl;
 		break;
 	    default:
-		cout << "[node "<<router->local_id<<"] DBS status:  NOTVALID!!" << endl;
+		cerr << "[node "<<router->local_id<<"] DBS status:  NOTVALID!!" << endl;
 		exit(0);
 	}
     }
     else
     {
-		cout << "[node "<<router->local_id<<"] print_status:  ERROR, router not set" << endl;
+		cerr << "[node "<<router->local_id<<"] print_status:  ERROR, router not set" << endl;
     }
 
 #endif
@@ -987,7 +988,7 @@ void DiSR::update_status()
 
     if (this->status==ASSIGNED && has_free_link() )
     {
-	cout << "[node "<<router->local_id<<"] DiSR::update_status(), can start_investigate_links() ! " << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::update_status(), can start_investigate_links() ! ";
 	start_investigate_links();
     }
 
@@ -1001,13 +1002,13 @@ void DiSR::update_status()
 	    if (bootstrap_timeout>0)
 	    {
 		if (bootstrap_timeout%1==0)
-		    cout << "[node "<<router->local_id<<"] DiSR::update_status(), bootstrap node emaining timeout: " << bootstrap_timeout << endl;
+		    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::update_status(), bootstrap node emaining timeout: " << bootstrap_timeout;
 	    }
 	    else // this condition should be really critical, assuming a proper timeout has been used
 	    {
-		cout << "CRITICAL [node "<<router->local_id<<"] DiSR::update_status(), bootstrap timeout RESET!" << endl;
+		LOG(router->ctx, LOG_DISR, LOG_WARNING) << "CRITICAL [node "<<router->local_id<<"] DiSR::update_status(), bootstrap timeout RESET!";
 		//assert(false);
-		bootstrap_timeout = GlobalParams::bootstrap_timeout;
+		bootstrap_timeout = router->ctx->params.bootstrap_timeout;
 		this->setStatus(BOOTSTRAP);
 	    }
 	}
@@ -1015,11 +1016,48 @@ void DiSR::update_status()
 
 }
 
+// true when update_status() has something to do even if no packet is
+// received, i.e. the node must be evaluated at the next cycle
+bool DiSR::needsUpdate() const
+{
+    if (this->status==BOOTSTRAP)
+	return true;
+
+    if (this->status==ASSIGNED && has_free_link())
+	return true;
+
+    if (this->status==CANDIDATE_STARTING && this->visited && bootstrap_timeout!=-1)
+	return true;
+
+    return false;
+}
+
+// number of upcoming update_status() calls that would do nothing but
+// count down the bootstrap timeout (INT_MAX if there is nothing to do)
+int DiSR::idleCycles() const
+{
+    if (this->status==CANDIDATE_STARTING && this->visited && bootstrap_timeout!=-1)
+	return max(bootstrap_timeout-1, 0);
+
+    return needsUpdate() ? 0 : INT_MAX;
+}
+
+// account for cycles in which update_status() was not called, see
+// idleCycles()
+void DiSR::skipCycles(const int cycles)
+{
+    if (this->status==CANDIDATE_STARTING && this->visited && bootstrap_timeout!=-1)
+    {
+	assert(cycles <= idleCycles());
+	bootstrap_timeout -= cycles;
+    }
+}
+
 // a visited node connected to not visited/tvisited links can start
 // investigating its links
 void DiSR::start_investigate_links()
 {
-	cout << "[node "<<router->local_id<<"] DiSR::start_investigate_links()" << endl;
+	LOG(router->ctx, LOG_DISR, LOG_INFO) << "[node "<<router->local_id<<"] DiSR::start_investigate_links()";
 
 	/////////////////////////////////////////////////////////////////////////////////
 	//must search for a segment
@@ -1042,15 +1080,15 @@ void DiSR::start_investigate_links()
 	    packet.type = SEGMENT_REQUEST;
 	    packet.dir_in = DIRECTION_LOCAL;
 	    packet.dir_out = candidate_link;
-	    packet.ttl = GlobalParams::ttl;
+	    packet.ttl = router->ctx->params.ttl;
 
-	    cout << "[node "<<router->local_id<<"] DiSR::start_investigate_links() injecting SEGMENT_REQUEST " << segment_id << " towards direction " << candidate_link << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::start_investigate_links() injecting SEGMENT_REQUEST " << segment_id << " towards direction " << candidate_link;
 	    router->inject_to_network(packet);
 
 	}
 	else
 	{
-	    cout << "[node  "<<router->local_id<<"] DiSR::start_investigate_link() WARNING, no suitable links!" << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_WARNING) << "[node  "<<router->local_id<<"] DiSR::start_investigate_link() WARNING, no suitable links!";
 	}
 
 }
@@ -1059,7 +1097,7 @@ void DiSR::bootstrap_node()
 {
 
 	// go directly to ACTIVE status 
-	cout << "[node "<<router->local_id<<"] DiSR::bootstrap_node() starting node BOOTSTRAP, ready to inject STARTING_SEGMENT_REQUEST" << endl;
+	LOG(router->ctx, LOG_DISR, LOG_INFO) << "[node "<<router->local_id<<"] DiSR::bootstrap_node() starting node BOOTSTRAP, ready to inject STARTING_SEGMENT_REQUEST";
 	
 	/////////////////////////////////////////////////////////////////////////////////
 	//must search for starting segment
@@ -1083,15 +1121,15 @@ void DiSR::bootstrap_node()
 	    packet.type = STARTING_SEGMENT_REQUEST;
 	    packet.dir_in = DIRECTION_LOCAL;
 	    packet.dir_out = candidate_link;
-	    packet.ttl = GlobalParams::bootstrap_timeout;
+	    packet.ttl = router->ctx->params.bootstrap_timeout;
 
-	    cout << "[node "<<router->local_id<<"] DiSR::bootstrap_node() injecting STARTING_SEGMENT_REQUEST " << segment_id << " towards direction " << candidate_link << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::bootstrap_node() injecting STARTING_SEGMENT_REQUEST " << segment_id << " towards direction " << candidate_link;
 	    router->inject_to_network(packet);
 
 	}
 	else
 	{
-	    cout << "[node  "<<router->local_id<<"] DiSR::bootstrap_node() CRITICAL! cant inject STARTING_SEGMENT_REQUEST (no suitable links)" << endl;
+	    LOG(router->ctx, LOG_DISR, LOG_WARNING) << "[node  "<<router->local_id<<"] DiSR::bootstrap_node() CRITICAL! cant inject STARTING_SEGMENT_REQUEST (no suitable links)";
 	}
 	///////////////////// end injecting starting segment //////
 
@@ -1107,12 +1145,12 @@ void DiSR::generate_segment_confirm(TPacket& p)
 
     if (p.type==STARTING_SEGMENT_REQUEST)
     {
-	cout << "[node "<<router->local_id<<"] DiSR::generate_segment_confirm() STARTING_SEGMENT_REQUEST " << segment_id << " from direction " << p.dir_in << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::generate_segment_confirm() STARTING_SEGMENT_REQUEST " << segment_id << " from direction " << (int)p.dir_in;
 	p.type = STARTING_SEGMENT_CONFIRM;
     }
     else if (p.type==SEGMENT_REQUEST)
     {
-	cout << "[node "<<router->local_id<<"] DiSR::generate_segment_confirm() SEGMENT_REQUEST " << segment_id << " from direction " << p.dir_in << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::generate_segment_confirm() SEGMENT_REQUEST " << segment_id << " from direction " << (int)p.dir_in;
 	p.type = SEGMENT_CONFIRM;
 
     }
@@ -1126,7 +1164,7 @@ void DiSR::generate_segment_confirm(TPacket& p)
     p.dir_in = DIRECTION_LOCAL;
     p.src_id = router->local_id; // required in non-starting segment confirmation packets
 
-    cout << "[node "<<router->local_id<<"] DiSR::generate_segment_confirm() injecting confirm with id " << segment_id << " towards direction " << p.dir_out << endl;
+    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::generate_segment_confirm() injecting confirm with id " << segment_id << " towards direction " << (int)p.dir_out;
     router->inject_to_network(p);
 
 }
@@ -1137,7 +1175,7 @@ void DiSR::generate_segment_cancel(TPacket& p)
 
     if (p.type==SEGMENT_REQUEST)
     {
-	cout << "[node "<<router->local_id<<"] DiSR::generate_segment_cancel() cancelling " << segment_id << " from direction " << p.dir_in << endl;
+	LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::generate_segment_cancel() cancelling " << segment_id << " from direction " << (int)p.dir_in;
 	p.type = SEGMENT_CANCEL;
     }
     else
@@ -1151,7 +1189,7 @@ void DiSR::generate_segment_cancel(TPacket& p)
     p.src_id = router->local_id; // required in non-starting segment confirmation packets
     p.ttl--;
 
-    cout << "[node "<<router->local_id<<"] DiSR::generate_segment_cancel() injecting SEGMENT_CANCEL with id " << segment_id << " (ttl " << p.ttl << " ) towards direction " << p.dir_out << endl;
+    LOG(router->ctx, LOG_DISR, LOG_DEBUG) << "[node "<<router->local_id<<"] DiSR::generate_segment_cancel() injecting SEGMENT_CANCEL with id " << segment_id << " (ttl " << p.ttl << " ) towards direction " << (int)p.dir_out;
     router->inject_to_network(p);
 
 }
@@ -1165,6 +1203,7 @@ void DiSR::reset()
     terminal = false;
     subnet = NOT_RESERVED;
     current_link = DIRECTION_NORTH;
+    assign_timestamp = 0;
 
     for (int i =0;i<DIRECTIONS;i++)
     {
@@ -1181,15 +1220,33 @@ void DiSR::reset()
     // Whener the router pointer is updated, status must be resetted
 
 
-    if ((router!=NULL) && (router->local_id == GlobalParams::bootstrap)) 
+    if ((router!=NULL) && (router->local_id == router->ctx->params.bootstrap)) 
     {
-	bootstrap_timeout = GlobalParams::bootstrap_timeout;
+	bootstrap_timeout = router->ctx->params.bootstrap_timeout;
 	status = BOOTSTRAP;
     }
     else
 	status = FREE;
 }
 
+// Back to the state set_router() left DiSR in, with all the directions
+// valid again (used between runs, before the new defects are applied)
+void DiSR::restore()
+{
+    for (int i =0;i<DIRECTIONS;i++)
+    {
+	link_visited[i].set(NOT_RESERVED,NOT_RESERVED);
+	link_tvisited[i].set(NOT_RESERVED,NOT_RESERVED);
+    }
+
+    if (router->local_id == router->ctx->params.bootstrap) 
+	status = BOOTSTRAP;
+    else
+	status = FREE;
+
+    reset_cyclelinks();
+}
+
 void DiSR::invalidate_direction(int d)
 {
     link_visited[d].set(NOT_VALID,NOT_VALID);
@@ -1200,11 +1257,11 @@ void DiSR::invalidate_direction(int d)
 void DiSR::free_direction(int d)
 {
     if (link_visited[d].isAssigned()) 
-	cout << "\n WARNING: avoiding freeing ASSIGNED link on DIR " << d << endl;
+	LOG(router->ctx, LOG_DISR, LOG_WARNING) << "WARNING: avoiding freeing ASSIGNED link on DIR " << d;
     else
 	link_visited[d].set(NOT_RESERVED,NOT_RESERVED);
 
-    if (!link_visited[d].isValid()) cout << "\n WARNING: freeing NOT VALID link on DIR " << d << endl;
+    if (!link_visited[d].isValid()) cerr << "\n WARNING: freeing NOT VALID link on DIR " << d << endl;
     assert(link_visited[d].isValid());
     //assert(!link_visited[d].isAssigned());
     link_tvisited[d].set(NOT_RESERVED,NOT_RESERVED);
@@ -1231,3 +1288,39 @@ double DiSR::get_assign_timestamp() const
 {
     return assign_timestamp;
 }
+
+void DiSR::save(TCheckpoint& cp) const
+{
+    cp.put(request_path);
+    cp.put(segID);
+    cp.put(visited);
+    cp.put(tvisited);
+    cp.put(link_visited);
+    cp.put(link_tvisited);
+    cp.put(terminal);
+    cp.put(subnet);
+    cp.put(bootstrap_timeout);
+    cp.put(current_link);
+    cp.put(cycle_start);
+    cp.put(cyclelinks_timeout);
+    cp.put(assign_timestamp);
+    cp.put(status);
+}
+
+void DiSR::load(TCheckpoint& cp)
+{
+    cp.get(request_path);
+    cp.get(segID);
+    cp.get(visited);
+    cp.get(tvisited);
+    cp.get(link_visited);
+    cp.get(link_tvisited);
+    cp.get(terminal);
+    cp.get(subnet);
+    cp.get(bootstrap_timeout);
+    cp.get(current_link);
+    cp.get(cycle_start);
+    cp.get(cyclelinks_timeout);
+    cp.get(assign_timestamp);
+    cp.get(status);
+}
@@ -0,0 +1,136 @@
+/*****************************************************************************
+
+  ForkServer.cpp -- Runs simulation requests in children of an elaborated network
+
+ *****************************************************************************/
+#include <fstream>
+#include <sstream>
+#include <sys/wait.h>
+#include "ForkServer.h"
+#include "CmdLineParser.h"
+#include "TStopConditions.h"
+
+//---------------------------------------------------------------------------
+
+ForkServer::ForkServer(SimulationContext& _ctx, int arg_num, char *arg_vet[]) : ctx(_ctx)
+{
+  for (int i=0; i<arg_num; i++)
+    base_args.push_back(arg_vet[i]);
+}
+
+//---------------------------------------------------------------------------
+
+bool ForkServer::serve(const string& control_fname)
+{
+  // Opening a named pipe waits for the first writer
+  ifstream control(control_fname.c_str());
+
+  if (!control)
+    return false;
+
+  cout << "Fork server ready, reading the requests from " << control_fname << endl;
+
+  string request;
+  int served = 0;
+
+  while (getline(control, request))
+  {
+      if (request.find_first_not_of(" \t\r") == string::npos)
+	  continue;
+
+      if ((int)children.size() >= ctx.params.fork_jobs)
+	  waitChild();
+
+      served++;
+      cout << "Request " << served << ": " << request << endl;
+
+      // Nothing buffered must be written twice, by the child as well
+      cout.flush();
+      TLog::flush();
+
+      pid_t pid = fork();
+
+      if (pid == 0)
+	  runRequest(request);
+
+      if (pid < 0)
+	  cerr << "Error: cannot fork request " << served << endl;
+      else
+	  children[pid] = served;
+  }
+
+  while (!children.empty())
+      waitChild();
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+// In the child: never returns
+void ForkServer::runRequest(const string& request)
+{
+  // The request options come after the server ones, and override them
+  vector<string> args = base_args;
+  istringstream iss(request);
+  string arg;
+
+  while (iss >> arg)
+      args.push_back(arg);
+
+  vector<char *> argv;
+  for (unsigned int i=0; i<args.size(); i++)
+      argv.push_back((char *)args[i].c_str());
+  argv.push_back(NULL);
+
+  // Exits on invalid options
+  SimulationParams params;
+  parseCmdLine(args.size(), &argv[0], params);
+
+  const SimulationParams& built = ctx.params;
+
+  if (params.mesh_dim_x != built.mesh_dim_x || params.mesh_dim_y != built.mesh_dim_y ||
+      params.buffer_depth != built.buffer_depth || params.engine != built.engine ||
+      params.threads != built.threads || params.log_file != built.log_file)
+  {
+      cerr << "Error: a request can not change the mesh, the buffers, the engine, the threads or the log" << endl;
+      exit(1);
+  }
+
+  cout << "\n Using seed " << params.rnd_generator_seed << endl;
+  ctx.reconfigure(params);
+
+  int stop_reason = ctx.simulate();
+
+  cout << "network simulation completed (stop condition: " << TStopConditions::describe(stop_reason) << ")." << endl;
+  cout << " ( " << ctx.getCurrentCycle() << " cycles executed)" << endl;
+
+  ctx.writeResults(stop_reason);
+
+  exit(0);
+}
+
+//---------------------------------------------------------------------------
+
+void ForkServer::waitChild()
+{
+  int status;
+  pid_t pid = wait(&status);
+
+  if (pid < 0)
+  {
+      // No children left, whatever the map says
+      children.clear();
+      return;
+  }
+
+  int served = children[pid];
+  children.erase(pid);
+
+  if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+      cout << "Request " << served << " completed" << endl;
+  else
+      cout << "Request " << served << " failed" << endl;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+/*****************************************************************************
+
+  ForkServer.h -- Runs simulation requests in children of an elaborated network
+
+ *****************************************************************************/
+#ifndef __FORKSERVER_H__
+#define __FORKSERVER_H__
+
+//---------------------------------------------------------------------------
+
+#include <map>
+#include <vector>
+#include <string>
+#include <unistd.h>
+#include "nanoxim.h"
+#include "SimulationContext.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// ForkServer -- serves the simulation requests read from a control file
+// (-fork_server FILE, typically a named pipe made with mkfifo) with
+// copies of a network elaborated once. Each line of the control file
+// holds the options of one simulation, on top of the ones the server was
+// started with, e.g.
+//
+//	-seed 12 -defective_links 0.1 -out results.12
+//
+// Every request is run by a child forked from the server, which shares
+// the elaborated network copy-on-write: the child takes its parameters,
+// draws the defect map for them (see SimulationContext::reconfigure()),
+// runs and writes its results file. Up to fork_jobs children run at the
+// same time, and the server reports the end of each one on the standard
+// output. It returns when the last writer closes the control file.
+//
+// A request can change anything but what the network was elaborated
+// for: the mesh, the buffers, the engine and its threads and the log.
+
+class ForkServer
+{
+ public:
+
+  ForkServer(SimulationContext& _ctx, int arg_num, char *arg_vet[]);
+
+  // Serve the requests up to the end of the control file. False if it
+  // can not be opened
+  bool serve(const string& control_fname);
+
+ private:
+
+  void runRequest(const string& request);
+  void waitChild();
+
+  SimulationContext&  ctx;
+  vector<string>      base_args;   // The command line the server was started with
+  map<pid_t, int>     children;    // Request served by each running child
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -9,13 +9,17 @@
  */
 
 #include "GlobalStats.h"
+#include "SimulationContext.h"
 #include <cstdio>
+#include <unistd.h>
 using namespace std;
 
 GlobalStats::GlobalStats(const TNet * _net)
 {
     net = _net;
+    ctx = net->ctx;
     DiSR_stats.latency = 0;
+    stop_condition = STOP_SIMULATION_TIME;
 
 #ifdef TESTING
     drained_total = 0;
@@ -33,99 +37,147 @@ void GlobalStats::updateLatency(double last)
     DiSR_stats.latency = last;
 }
 
-void GlobalStats::generate_disr_stats()
+void GlobalStats::setStopCondition(const int reason)
 {
+    stop_condition = reason;
+}
 
-    compute_disr_node_coverage();
-    compute_disr_link_coverage();
-    compute_disr_latency();
-
-    /*
-    compute_disr_average_path_length();
-    compute_disr_average_link_weight();
-    compute_disr_unidirectional_turn_restrictions();
-    */
+void TSegmentIndex::clear(const int nodes)
+{
+    ids.clear();
+    this->nodes.clear();
+    links.clear();
+    dense.assign(nodes * DIRECTIONS + 1, NOT_VALID);
 }
 
-/* get the percentage of nodes covered/assigned by the DiSR 
- *
- * */
-void GlobalStats::compute_disr_node_coverage()
+int TSegmentIndex::lookup(const TSegmentId& id)
 {
-    int covered = 0;
+    // The last key is for the id of an assigned node that could not
+    // start any segment, e.g. a bootstrap node with no working links
+    int key = dense.size() - 1;
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+    if (id.isAssigned())
     {
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
-	    if (net->t[x][y]->r->disr.isAssigned())
-	    {
-		covered++;
-		TSegmentId seg_id = net->t[x][y]->r->disr.getLocalSegmentID();
-		int node_id = net->t[x][y]->r->local_id;
-		this->DiSR_stats.segmentList[seg_id].push_back(node_id);
-		//cout << "Adding node " << node_id << " to segment " << seg_id << endl;
-	    }
+	assert(id.getLink() < DIRECTIONS);
+	key = id.getNode() * DIRECTIONS + id.getLink();
+    }
+
+    if (dense[key] == NOT_VALID)
+    {
+	dense[key] = ids.size();
+	ids.push_back(id);
+	nodes.push_back(vector<int>());
+	links.push_back(vector<int>());
     }
 
-    this->DiSR_stats.total_nodes = GlobalParams::mesh_dim_y * GlobalParams::mesh_dim_x;
-    this->DiSR_stats.covered_nodes = covered;
-    this->DiSR_stats.node_coverage = (double)covered/this->DiSR_stats.total_nodes;
-    this->DiSR_stats.nsegments = this->DiSR_stats.segmentList.size();
-    this->DiSR_stats.average_seg_length = covered/(double)(this->DiSR_stats.nsegments);
+    return dense[key];
 }
 
-/* get the percentage of links covered/assigned by the DiSR 
+void GlobalStats::take_disr_snapshot(vector<TDiSRNodeState>& snapshot) const
+{
+    snapshot.resize(net->t.size());
+
+    for (unsigned int id = 0; id < net->t.size(); id++)
+    {
+	const DiSR& disr = net->t[id]->r->disr;
+	TDiSRNodeState& state = snapshot[id];
+
+	state.id = net->t[id]->r->local_id;
+	state.assigned = disr.isAssigned();
+	state.segment = disr.getLocalSegmentID();
+	state.link_east = disr.getLinkSegmentID(DIRECTION_EAST);
+	state.link_south = disr.getLinkSegmentID(DIRECTION_SOUTH);
+	state.assign_timestamp = disr.get_assign_timestamp();
+    }
+}
+
+/* percentage of nodes and links covered/assigned by the DiSR, the
+ * segments they make up and the time the DiSR process took
  *
  * */
-void GlobalStats::compute_disr_link_coverage()
+void GlobalStats::generate_disr_stats()
 {
-    int covered = 0;
+    vector<TDiSRNodeState> snapshot;
+    int dim_x = ctx->params.mesh_dim_x;
+    int dim_y = ctx->params.mesh_dim_y;
+    int covered_nodes = 0;
+    int covered_links = 0;
     int total_links = 0;
-    int defective = 0 ;
+    int defective = 0;
+
+    take_disr_snapshot(snapshot);
+    DiSR_stats.segments.clear(snapshot.size());
 
-    // horizontal edges...
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+    // nodes by id, i.e. row by row
+    for (unsigned int id = 0; id < snapshot.size(); id++)
     {
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
-	{
-	    if (x != GlobalParams::mesh_dim_x-1)
-	    {
-		total_links++;
+	const TDiSRNodeState& state = snapshot[id];
+	int x = id % dim_x;
+	int y = id / dim_x;
 
-		TSegmentId tid = net->t[x][y]->r->disr.getLinkSegmentID(DIRECTION_EAST);
-		if (tid.isAssigned())
-		    covered++;
+	if (state.assigned)
+	{
+	    covered_nodes++;
+	    DiSR_stats.segments.nodes[DiSR_stats.segments.lookup(state.segment)].push_back(state.id);
+	}
 
-		if (!(tid.isValid()) )
-		    defective++;
+	// horizontal edges...
+	if (x != dim_x-1)
+	{
+	    total_links++;
 
+	    if (state.link_east.isAssigned())
+	    {
+		covered_links++;
+		DiSR_stats.segments.links[DiSR_stats.segments.lookup(state.link_east)].push_back(state.id * DIRECTIONS + DIRECTION_EAST);
 	    }
+
+	    if (!(state.link_east.isValid()) )
+		defective++;
 	}
-    }
 
-    // vertical edges...
-    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
-    {
-	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	// vertical edges...
+	if (y != dim_y-1)
 	{
-	    if (y != GlobalParams::mesh_dim_y-1)
-	    {
-		total_links++;
-		TSegmentId tid = net->t[x][y]->r->disr.getLinkSegmentID(DIRECTION_SOUTH);
-		if (tid.isAssigned())
-		    covered++;
+	    total_links++;
 
-		if (!(tid.isValid()) )
-		    defective++;
+	    if (state.link_south.isAssigned())
+	    {
+		covered_links++;
+		DiSR_stats.segments.links[DiSR_stats.segments.lookup(state.link_south)].push_back(state.id * DIRECTIONS + DIRECTION_SOUTH);
 	    }
+
+	    if (!(state.link_south.isValid()) )
+		defective++;
 	}
+
+	if (state.assign_timestamp > DiSR_stats.latency)
+	    updateLatency(state.assign_timestamp);
     }
 
+    // A link may belong to a segment none of whose nodes is assigned
+    int nsegments = 0;
+    for (unsigned int i = 0; i < DiSR_stats.segments.nodes.size(); i++)
+	if (!DiSR_stats.segments.nodes[i].empty())
+	    nsegments++;
+
+    this->DiSR_stats.total_nodes = dim_y * dim_x;
+    this->DiSR_stats.covered_nodes = covered_nodes;
+    this->DiSR_stats.node_coverage = (double)covered_nodes/this->DiSR_stats.total_nodes;
+    this->DiSR_stats.nsegments = nsegments;
+    this->DiSR_stats.average_seg_length = covered_nodes/(double)(this->DiSR_stats.nsegments);
+
     this->DiSR_stats.total_links = total_links;
-    this->DiSR_stats.covered_links = covered;
-    this->DiSR_stats.link_coverage = (double)covered/total_links;
+    this->DiSR_stats.covered_links = covered_links;
+    this->DiSR_stats.link_coverage = (double)covered_links/total_links;
     this->DiSR_stats.defective_nodes = defective;
-    this->DiSR_stats.working_link_coverage = (double)covered/(total_links-defective);
+    this->DiSR_stats.working_link_coverage = (double)covered_links/(total_links-defective);
+
+    /*
+    compute_disr_average_path_length();
+    compute_disr_average_link_weight();
+    compute_disr_unidirectional_turn_restrictions();
+    */
 }
 
 
@@ -134,15 +186,15 @@ double GlobalStats::getAverageDelay()
     unsigned int total_packets = 0;
     double avg_delay = 0.0;
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++) {
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++) {
 	    unsigned int received_packets =
-		net->t[x][y]->r->stats.getReceivedPackets();
+		net->getNode(x, y)->r->stats.getReceivedPackets();
 
 	    if (received_packets) {
 		avg_delay +=
 		    received_packets *
-		    net->t[x][y]->r->stats.getAverageDelay();
+		    net->getNode(x, y)->r->stats.getAverageDelay();
 		total_packets += received_packets;
 	    }
 	}
@@ -166,12 +218,12 @@ double GlobalStats::getMaxDelay()
 {
     double maxd = -1.0;
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++) {
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++) {
 	    TCoord coord;
 	    coord.x = x;
 	    coord.y = y;
-	    int node_id = coord2Id(coord);
+	    int node_id = coord2Id(coord, ctx->params);
 	    double d = getMaxDelay(node_id);
 	    if (d > maxd)
 		maxd = d;
@@ -182,13 +234,13 @@ double GlobalStats::getMaxDelay()
 
 double GlobalStats::getMaxDelay(const int node_id)
 {
-    TCoord coord = id2Coord(node_id);
+    TCoord coord = id2Coord(node_id, ctx->params);
 
     unsigned int received_packets =
-	net->t[coord.x][coord.y]->r->stats.getReceivedPackets();
+	net->getNode(coord.x, coord.y)->r->stats.getReceivedPackets();
 
     if (received_packets)
-	return net->t[coord.x][coord.y]->r->stats.getMaxDelay();
+	return net->getNode(coord.x, coord.y)->r->stats.getMaxDelay();
     else
 	return -1.0;
 }
@@ -206,16 +258,16 @@ vector < vector < double > > GlobalStats::getMaxDelayMtx()
 {
     vector < vector < double > > mtx;
 
-    mtx.resize(GlobalParams::mesh_dim_y);
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	mtx[y].resize(GlobalParams::mesh_dim_x);
+    mtx.resize(ctx->params.mesh_dim_y);
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	mtx[y].resize(ctx->params.mesh_dim_x);
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++) {
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++) {
 	    TCoord coord;
 	    coord.x = x;
 	    coord.y = y;
-	    int id = coord2Id(coord);
+	    int id = coord2Id(coord, ctx->params);
 	    mtx[y][x] = getMaxDelay(id);
 	}
 
@@ -237,14 +289,14 @@ double GlobalStats::getAverageThroughput()
     unsigned int total_comms = 0;
     double avg_throughput = 0.0;
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++) {
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++) {
 	    unsigned int ncomms =
-		net->t[x][y]->r->stats.getTotalCommunications();
+		net->getNode(x, y)->r->stats.getTotalCommunications();
 
 	    if (ncomms) {
 		avg_throughput +=
-		    ncomms * net->t[x][y]->r->stats.getAverageThroughput();
+		    ncomms * net->getNode(x, y)->r->stats.getAverageThroughput();
 		total_comms += ncomms;
 	    }
 	}
@@ -258,9 +310,9 @@ unsigned int GlobalStats::getReceivedPackets()
 {
     unsigned int n = 0;
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
-	    n += net->t[x][y]->r->stats.getReceivedPackets();
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++)
+	    n += net->getNode(x, y)->r->stats.getReceivedPackets();
 
     return n;
 }
@@ -269,11 +321,11 @@ unsigned int GlobalStats::getReceivedFlits()
 {
     unsigned int n = 0;
 
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++) {
-	    n += net->t[x][y]->r->stats.getReceivedFlits();
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++) {
+	    n += net->getNode(x, y)->r->stats.getReceivedFlits();
 #ifdef TESTING
-	    drained_total += net->t[x][y]->r->local_drained;
+	    drained_total += net->getNode(x, y)->r->local_drained;
 #endif
 	}
 
@@ -286,17 +338,17 @@ double GlobalStats::getThroughput()
     int total_cycles;
     /*
     int total_cycles =
-	GlobalParams::simulation_time - GlobalParams::stats_warm_up_time;
+	ctx->params.simulation_time - ctx->params.stats_warm_up_time;
 
 	*/
-    //  int number_of_ip = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    //  int number_of_ip = ctx->params.mesh_dim_x * ctx->params.mesh_dim_y;
     //  return (double)getReceivedFlits()/(double)(total_cycles * number_of_ip);
 
     unsigned int n = 0;
     unsigned int trf = 0;
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++) {
-	    unsigned int rf = net->t[x][y]->r->stats.getReceivedFlits();
+    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++) {
+	    unsigned int rf = net->getNode(x, y)->r->stats.getReceivedFlits();
 
 	    if (rf != 0)
 		n++;
@@ -307,19 +359,6 @@ double GlobalStats::getThroughput()
 
 }
 
-void GlobalStats::compute_disr_latency()
-{
-
-    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
-	{
-	    double timestamp = net->t[x][y]->r->disr.get_assign_timestamp();
-	    if ( timestamp > DiSR_stats.latency)
-		updateLatency(timestamp);
-	}
-
-}
-
 void GlobalStats::drawGraphviz()
 {
     FILE * fp;
@@ -331,41 +370,41 @@ void GlobalStats::drawGraphviz()
 	// draw the network layout and declare nodes
 	fprintf(fp,"\n digraph G { graph [layout=dot] ");
 
-	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	for (int y = 0; y < ctx->params.mesh_dim_y; y++)
 	{
 	    fprintf(fp,"\n {rank=same; ");
-	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+	    for (int x = 0; x < ctx->params.mesh_dim_x; x++)
 	    {
-		TSegmentId tid = net->t[x][y]->r->disr.getLocalSegmentID();
-		int local_id = net->t[x][y]->r->local_id;
+		TSegmentId tid = net->getNode(x, y)->r->disr.getLocalSegmentID();
+		int local_id = net->getNode(x, y)->r->local_id;
 
-		if (net->t[x][y]->r->disr.isAssigned())
+		if (net->getNode(x, y)->r->disr.isAssigned())
 		{
-		    if (local_id == GlobalParams::bootstrap)
+		    if (local_id == ctx->params.bootstrap)
 			fprintf(fp,"N%d [shape=circle, style=filled, fixedsize=true]; ",local_id);
 		    else
 			fprintf(fp,"N%d [shape=circle, fixedsize=true]; ",local_id);
 
 		}
 		else
-		    if (net->t[x][y]->valid )
-		    fprintf(fp,"N%d [shape=square, fixedsize=true]; ",net->t[x][y]->r->local_id);
+		    if (net->getNode(x, y)->valid )
+		    fprintf(fp,"N%d [shape=square, fixedsize=true]; ",net->getNode(x, y)->r->local_id);
 		else // defective/not valid node
-		    fprintf(fp,"N%d [shape=square, style=dotted, fixedsize=true, label=X]; ",net->t[x][y]->r->local_id);
+		    fprintf(fp,"N%d [shape=square, style=dotted, fixedsize=true, label=X]; ",net->getNode(x, y)->r->local_id);
 	    }
 	    fprintf(fp," }");
 	}
 
 	// draw horizontal edges...
-	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	for (int y = 0; y < ctx->params.mesh_dim_y; y++)
 	{
-	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+	    for (int x = 0; x < ctx->params.mesh_dim_x; x++)
 	    {
-		int curr_id = net->t[x][y]->r->local_id;
+		int curr_id = net->getNode(x, y)->r->local_id;
 
-		if (x != GlobalParams::mesh_dim_x-1)
+		if (x != ctx->params.mesh_dim_x-1)
 		{
-		    TSegmentId tid = net->t[x][y]->r->disr.getLinkSegmentID(DIRECTION_EAST);
+		    TSegmentId tid = net->getNode(x, y)->r->disr.getLinkSegmentID(DIRECTION_EAST);
 		    if (tid.isAssigned())
 			fprintf(fp,"\nN%d->N%d [dir=none, color=red, style=bold, label=\"%d.%d\"]",curr_id,curr_id+1,tid.getNode(),tid.getLink());
 		    else if (tid.isFree())
@@ -379,16 +418,16 @@ void GlobalStats::drawGraphviz()
 	}
 
 	// draw vertical edges...
-	for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+	for (int x = 0; x < ctx->params.mesh_dim_x; x++)
 	{
-	    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    for (int y = 0; y < ctx->params.mesh_dim_y; y++)
 	    {
-		int curr_id = net->t[x][y]->r->local_id;
-		int south_id = net->t[x][y]->r->getNeighborId(curr_id,DIRECTION_SOUTH);
+		int curr_id = net->getNode(x, y)->r->local_id;
+		int south_id = net->getNode(x, y)->r->getNeighborId(curr_id,DIRECTION_SOUTH);
 
-		if (y != GlobalParams::mesh_dim_y-1)
+		if (y != ctx->params.mesh_dim_y-1)
 		{
-		    TSegmentId tid = net->t[x][y]->r->disr.getLinkSegmentID(DIRECTION_SOUTH);
+		    TSegmentId tid = net->getNode(x, y)->r->disr.getLinkSegmentID(DIRECTION_SOUTH);
 		    if (tid.isAssigned())
 			fprintf(fp,"\nN%d->N%d [dir=none, color=red, style=bold, label=\"%d.%d\"]",curr_id,south_id,tid.getNode(),tid.getLink());
 		    else if (tid.isFree())
@@ -406,12 +445,12 @@ void GlobalStats::drawGraphviz()
 	fclose(fp);
 	char cmd[200];
 	sprintf(cmd,"dot -Tpng -o %s.png %s",fn.c_str(),fn.c_str());
-	cout << cmd << endl;
+	LOG(ctx, LOG_STATS, LOG_INFO) << cmd;
         system(cmd);
     }
     else
     {
-	cout << "\n Cannot write output graphwiz file...";
+	cerr << "\n Cannot write output graphwiz file..." << endl;
     }
 }
 
@@ -420,25 +459,30 @@ string GlobalStats::basefilename() const
     char fn[100];
 
     sprintf(fn,"_%dx%d_b%d_bimm%d_btime%d_cl%d_defl%g_defn%g_ttl%d_seed%d",
-	    GlobalParams::mesh_dim_x,
-	    GlobalParams::mesh_dim_y,
-	    GlobalParams::bootstrap,
-	    GlobalParams::bootstrap_immunity,
-	    GlobalParams::bootstrap_timeout,
-	    GlobalParams::cyclelinks,
-	    GlobalParams::defective_links,
-	    GlobalParams::defective_nodes,
-	    GlobalParams::ttl,
-	    GlobalParams::rnd_generator_seed);
+	    ctx->params.mesh_dim_x,
+	    ctx->params.mesh_dim_y,
+	    ctx->params.bootstrap,
+	    ctx->params.bootstrap_immunity,
+	    ctx->params.bootstrap_timeout,
+	    ctx->params.cyclelinks,
+	    ctx->params.defective_links,
+	    ctx->params.defective_nodes,
+	    ctx->params.ttl,
+	    ctx->params.rnd_generator_seed);
     return string(fn);
 }
 
 void GlobalStats::writeStats()
 {
-    string fn = basefilename()+".txt";
+    const string& out = ctx->params.output_file;
+    string fn = out.empty() ? basefilename()+".txt" : out;
 
+    // All the runs of a batch end up in the one -out file
     ofstream of;
-    of.open (fn.c_str());
+    if (!out.empty() && ctx->run > 0)
+	of.open (fn.c_str(), ios::app);
+    else
+	of.open (fn.c_str());
     generate_disr_stats();
     of << " DiSR analytical results " << endl;
     of << "--------------------------------------------------- " << endl;
@@ -453,22 +497,53 @@ void GlobalStats::writeStats()
     of << "number of segments: " << DiSR_stats.nsegments << endl;
     of << "average segment length: " << DiSR_stats.average_seg_length<< endl;
     of << "latency: " << DiSR_stats.latency<< endl;
+    of << "stop condition: " << TStopConditions::describe(stop_condition) << endl;
+    of << "simulated cycles: " << ctx->getCurrentCycle() - DEFAULT_RESET_TIME << endl;
 
-    map<TSegmentId, vector<int> >::const_iterator it;
+    const TSegmentIndex& segments = DiSR_stats.segments;
 
-    for (it = DiSR_stats.segmentList.begin(); it!=DiSR_stats.segmentList.end(); ++it)
+    if (LOG_ENABLED(ctx, LOG_STATS, LOG_INFO))
+    for (unsigned int s = 0; s < segments.ids.size(); s++)
+    if (!segments.nodes[s].empty())
     {
-	TSegmentId tmpid = it->first;
-	cout <<  "\n Segment " << tmpid << ": ";
-	for (unsigned int i = 0; i< DiSR_stats.segmentList[tmpid].size(); i++)
-	    cout << DiSR_stats.segmentList[tmpid][i] << " , ";
+	TLogRecord record(ctx, LOG_STATS);
+	record.stream() <<  "Segment " << segments.ids[s] << ": ";
+	for (unsigned int i = 0; i< segments.nodes[s].size(); i++)
+	    record.stream() << segments.nodes[s][i] << " , ";
 
     }
 
-    char cmd[200];
-    sprintf(cmd,"ln -sf %s results.txt",fn.c_str());
-    of << cmd << endl;
     of.close();
-    system(cmd);
 
+    // Without -out, results.txt always points to the latest results
+    if (out.empty())
+    {
+	unlink("results.txt");
+	if (symlink(fn.c_str(), "results.txt") != 0)
+	    cerr << "\n Cannot link results.txt to " << fn << endl;
+    }
+
+}
+
+SimulationResults GlobalStats::getResults()
+{
+    SimulationResults results;
+
+    generate_disr_stats();
+
+    results.total_nodes = DiSR_stats.total_nodes;
+    results.total_links = DiSR_stats.total_links;
+    results.defective_nodes = DiSR_stats.defective_nodes;
+    results.covered_nodes = DiSR_stats.covered_nodes;
+    results.covered_links = DiSR_stats.covered_links;
+    results.node_coverage = DiSR_stats.node_coverage;
+    results.link_coverage = DiSR_stats.link_coverage;
+    results.working_link_coverage = DiSR_stats.working_link_coverage;
+    results.nsegments = DiSR_stats.nsegments;
+    results.average_seg_length = DiSR_stats.average_seg_length;
+    results.latency = DiSR_stats.latency;
+    results.stop_reason = stop_condition;
+    results.simulated_cycles = ctx->getCurrentCycle() - DEFAULT_RESET_TIME;
+
+    return results;
 }
@@ -17,8 +17,31 @@
 #include <map>
 #include "TNet.h"
 #include "TNode.h"
+#include "TStopConditions.h"
 using namespace std;
 
+// Segments found in the network, densely numbered in order of appearance.
+// A segment id (node, link) is keyed as node*DIRECTIONS+link, as link is
+// the direction the segment left its starting node from. Assigned nodes
+// with no segment id share one more key
+class TSegmentIndex {
+
+  public:
+
+    void clear(const int nodes);
+
+    // Dense index of the segment, added if not seen yet
+    int lookup(const TSegmentId& id);
+
+    vector<TSegmentId> ids;          // By dense index
+    vector<vector<int> > nodes;      // Nodes assigned to each segment
+    vector<vector<int> > links;      // Links of each segment, as node*DIRECTIONS+direction
+
+  private:
+
+    vector<int> dense;               // Dense index by key, NOT_VALID if not seen
+};
+
 class GlobalStats {
 
   public:
@@ -71,10 +94,16 @@ class GlobalStats {
     // Shows global statistics
     void writeStats();
 
+    // Returns the DiSR results of the run
+    SimulationResults getResults();
+
     void drawGraphviz();
 
     void updateLatency(double last);
 
+    // Reason the simulation ended for, see STOP_* in nanoxim.h
+    void setStopCondition(const int reason);
+
 
 #ifdef TESTING
     unsigned int drained_total;
@@ -82,14 +111,24 @@ class GlobalStats {
 
   private:
     // DiSR stats functions and structures ////////////////////
+    // Node and link coverage, segments and latency (the time required
+    // to complete the whole DiSR process), in a single pass over the
+    // snapshot of the DiSR state
     void generate_disr_stats();
-    /*  percentage of nodes covered/assigned by the DiSR */
-    void compute_disr_node_coverage();
-    /*  percentage of nodes covered/assigned by the DiSR */
-    void compute_disr_link_coverage();
 
-    // time required to complete the whole DiSR proces 
-    void compute_disr_latency();
+    // DiSR state of a node, as far as the stats are concerned
+    struct TDiSRNodeState
+    {
+	int id;
+	bool assigned;
+	TSegmentId segment;
+	TSegmentId link_east;      // Segment of the link to the east neighbor
+	TSegmentId link_south;     // Segment of the link to the south neighbor
+	double assign_timestamp;
+    };
+
+    // DiSR state of every node, by id
+    void take_disr_snapshot(vector<TDiSRNodeState>& snapshot) const;
 
     struct 
     {
@@ -101,7 +140,7 @@ class GlobalStats {
 	double node_coverage;
 	double link_coverage;
 	double working_link_coverage;
-	map<TSegmentId,vector<int> > segmentList;
+	TSegmentIndex segments;
 	int nsegments;
 	double average_seg_length;
 	double latency;
@@ -110,8 +149,11 @@ class GlobalStats {
 
     string basefilename() const;
 
+    int stop_condition;
+
 
     const TNet *net;
+    const SimulationContext *ctx;
 };
 
 #endif
@@ -0,0 +1,378 @@
+/*****************************************************************************
+
+  SimulationContext.cpp -- Simulation context implementation
+
+ *****************************************************************************/
+#include <sstream>
+#include "SimulationContext.h"
+#include "TStopConditions.h"
+#include "GlobalStats.h"
+
+//---------------------------------------------------------------------------
+
+pthread_mutex_t SimulationContext::elaboration_mutex = PTHREAD_MUTEX_INITIALIZER;
+int SimulationContext::contexts = 0;
+
+//---------------------------------------------------------------------------
+
+SimulationParams::SimulationParams()
+{
+  mesh_dim_x = DEFAULT_MESH_DIM_X;
+  mesh_dim_y = DEFAULT_MESH_DIM_Y;
+  buffer_depth = DEFAULT_BUFFER_DEPTH;
+  routing_algorithm = ROUTING_XY;
+  verbose_mode = DEFAULT_VERBOSE_MODE;
+  simulation_time = DEFAULT_SIMULATION_TIME;
+  rnd_generator_seed = time(NULL) + getpid();
+  disr = DEFAULT_DISR_SETUP;
+  bootstrap = DEFAULT_DISR_BOOTSTRAP_NODE;
+  ttl = DEFAULT_MESH_DIM_X;
+  bootstrap_timeout = DEFAULT_BOOTSTRAP_TIMEOUT;
+  bootstrap_immunity = DEFAULT_BOOTSTRAP_IMMUNITY;
+  graphviz = DEFAULT_GRAPHVIZ;
+  cyclelinks = DEFAULT_CYCLE_LINKS;
+  engine = DEFAULT_ENGINE;
+  threads = DEFAULT_THREADS;
+  stop_converged = DEFAULT_STOP_CONVERGED;
+  stop_coverage = DEFAULT_STOP_COVERAGE;
+  max_wallclock = DEFAULT_MAX_WALLCLOCK;
+  defective_links = 0;
+  defective_nodes = 0;
+  runs = DEFAULT_RUNS;
+  log_categories = DEFAULT_LOG_CATEGORIES;
+  checkpoint_cycle = 0;
+  fork_jobs = DEFAULT_FORK_JOBS;
+}
+
+//---------------------------------------------------------------------------
+
+SimulationContext::SimulationContext(const SimulationParams& _params)
+{
+  params = _params;
+  rng.seed(params.rnd_generator_seed);
+  net = NULL;
+  engine = NULL;
+  trace = NULL;
+  run = 0;
+  restored = false;
+  clock = NULL;
+  reset = NULL;
+  systemc_cycle_offset = 0;
+
+  pthread_mutex_lock(&elaboration_mutex);
+  id = contexts++;
+  pthread_mutex_unlock(&elaboration_mutex);
+}
+
+//---------------------------------------------------------------------------
+
+SimulationContext::~SimulationContext()
+{
+  bool native = (engine != NULL);
+
+  delete engine;
+  delete trace;
+
+  // The modules and channels driven by the SystemC engine stay with the
+  // kernel. The others were never run by it, and are removed from the
+  // object hierarchy as they were added to it
+  if (native)
+  {
+    pthread_mutex_lock(&elaboration_mutex);
+    delete net;
+    pthread_mutex_unlock(&elaboration_mutex);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void SimulationContext::build()
+{
+  assert(net == NULL);
+
+  // The first context keeps the plain names
+  ostringstream name;
+  name << "Net";
+  if (id > 0)
+    name << id;
+
+  // The SystemC object hierarchy is global, whatever the engine
+  pthread_mutex_lock(&elaboration_mutex);
+
+  net = new TNet(name.str().c_str(), this);
+
+  if (params.engine == ENGINE_SYSTEMC)
+  {
+    // TODO: check for nanorealistic frequencies
+    clock = new sc_clock((name.str() + "_clock").c_str(), 1, SC_NS);
+    reset = new sc_signal<bool>((name.str() + "_reset").c_str());
+    net->clock(*clock);
+    net->reset(*reset);
+  }
+
+  pthread_mutex_unlock(&elaboration_mutex);
+
+  if (params.engine == ENGINE_NATIVE)
+    engine = new TNativeEngine(net);
+
+  if (!params.trace_file.empty())
+  {
+    trace = new TTrace(net->t.size());
+    if (!trace->open(params.trace_file, params.mesh_dim_x, params.mesh_dim_y))
+    {
+      cerr << "Error: cannot create the trace file " << params.trace_file << endl;
+      exit(1);
+    }
+  }
+
+  // The defect map comes before anything the run prints
+  TLog::flush();
+}
+
+//---------------------------------------------------------------------------
+
+void SimulationContext::restart(const int seed)
+{
+  params.rnd_generator_seed = seed;
+  rng.seed(seed);
+  run++;
+  if (trace)
+    trace->setRun(run);
+  net->restart();
+}
+
+//---------------------------------------------------------------------------
+
+void SimulationContext::reconfigure(const SimulationParams& _params)
+{
+  params = _params;
+  rng.seed(params.rnd_generator_seed);
+  net->restart();
+}
+
+//---------------------------------------------------------------------------
+
+int SimulationContext::simulate()
+{
+  int stop_reason = STOP_SIMULATION_TIME;
+
+  if (engine)
+  {
+      // Reset the chip (unless restored) and run the simulation up to
+      // simulation_time cycles past the reset
+      int end_cycle = DEFAULT_RESET_TIME + params.simulation_time;
+
+      if (restored)
+      {
+	  restored = false;
+	  cout << "Restored at cycle " << engine->current_cycle << "! Now running (native engine, " << params.threads << " threads) up to cycle " << end_cycle << "..." << endl;
+      }
+      else
+      {
+	  cout << "Reset...";
+	  engine->reset();
+	  cout << " done! Now running (native engine, " << params.threads << " threads) for " << params.simulation_time << " cycles..." << endl;
+      }
+
+      int checkpoint = params.checkpoint_file.empty() ? 0 : params.checkpoint_cycle;
+
+      if (checkpoint > engine->current_cycle && checkpoint <= end_cycle)
+      {
+	  stop_reason = engine->run(checkpoint - (int)engine->current_cycle);
+
+	  if (stop_reason == STOP_SIMULATION_TIME)
+	  {
+	      if (!saveCheckpoint(params.checkpoint_file))
+	      {
+		  cerr << "Error: cannot write the checkpoint " << params.checkpoint_file << endl;
+		  exit(1);
+	      }
+	      cout << "Checkpoint at cycle " << checkpoint << " saved to " << params.checkpoint_file << endl;
+	  }
+	  else
+	      cout << "No checkpoint, the run stopped at cycle " << engine->current_cycle << endl;
+      }
+
+      if (stop_reason == STOP_SIMULATION_TIME && engine->current_cycle < end_cycle)
+	  stop_reason = engine->run(end_cycle - (int)engine->current_cycle);
+  }
+  else
+  {
+      // Reset the chip and run the simulation. The reset branches are
+      // idempotent, so a single cycle leaves the network as
+      // DEFAULT_RESET_TIME cycles would, and the run is timed as if they
+      // had elapsed
+      reset->write(1);
+      cout << "Reset...";
+      sc_start(1, SC_NS);
+      reset->write(0);
+      setSystemCCycle(DEFAULT_RESET_TIME);
+      cout << " done! Now running for " << params.simulation_time << " cycles..." << endl;
+
+      TStopConditions stop_conditions(net);
+
+      if (!stop_conditions.enabled())
+	  sc_start(params.simulation_time, SC_NS);
+      else
+      {
+	  // Step one cycle at a time to check the stop conditions
+	  for (int c = 0; c < params.simulation_time; c++)
+	  {
+	      sc_start(1, SC_NS);
+
+	      int reason = stop_conditions.check(params.stop_converged && net->isQuiescent(),
+						 params.stop_coverage > 0 ? net->coveredNodes() : 0);
+	      if (reason != STOP_NONE)
+	      {
+		  stop_reason = reason;
+		  break;
+	      }
+	  }
+      }
+  }
+
+  TLog::flush();
+  if (trace)
+    trace->flush();
+
+  return stop_reason;
+}
+
+//---------------------------------------------------------------------------
+
+void SimulationContext::writeResults(const int stop_reason)
+{
+  GlobalStats gs(net);
+
+  gs.setStopCondition(stop_reason);
+  if (params.graphviz)
+      gs.drawGraphviz();
+  gs.writeStats();
+  TLog::flush();
+}
+
+//---------------------------------------------------------------------------
+
+// The parameters the network depends on, in the checkpoint header
+static void putCheckpointParams(TCheckpoint& cp, const SimulationParams& params)
+{
+  char magic[8] = CHECKPOINT_MAGIC;
+
+  cp.put(magic);
+  cp.put((int)CHECKPOINT_VERSION);
+  cp.put(params.mesh_dim_x);
+  cp.put(params.mesh_dim_y);
+  cp.put(params.buffer_depth);
+  cp.put(params.routing_algorithm);
+  cp.put(params.rnd_generator_seed);
+  cp.put(params.disr);
+  cp.put(params.bootstrap);
+  cp.put(params.bootstrap_timeout);
+  cp.put(params.ttl);
+  cp.put(params.bootstrap_immunity);
+  cp.put(params.cyclelinks);
+  cp.put(params.defective_links);
+  cp.put(params.defective_nodes);
+}
+
+//---------------------------------------------------------------------------
+
+static void getCheckpointParams(TCheckpoint& cp, SimulationParams& params)
+{
+  char magic[8] = CHECKPOINT_MAGIC;
+
+  cp.expect(magic);
+  cp.expect((int)CHECKPOINT_VERSION);
+  cp.get(params.mesh_dim_x);
+  cp.get(params.mesh_dim_y);
+  cp.get(params.buffer_depth);
+  cp.get(params.routing_algorithm);
+  cp.get(params.rnd_generator_seed);
+  cp.get(params.disr);
+  cp.get(params.bootstrap);
+  cp.get(params.bootstrap_timeout);
+  cp.get(params.ttl);
+  cp.get(params.bootstrap_immunity);
+  cp.get(params.cyclelinks);
+  cp.get(params.defective_links);
+  cp.get(params.defective_nodes);
+}
+
+//---------------------------------------------------------------------------
+
+bool SimulationContext::saveCheckpoint(const string& fname) const
+{
+  TCheckpoint cp;
+
+  assert(engine);
+
+  if (!cp.create(fname))
+    return false;
+
+  putCheckpointParams(cp, params);
+  net->save(cp);
+  engine->save(cp);
+
+  return cp.close();
+}
+
+//---------------------------------------------------------------------------
+
+bool SimulationContext::loadCheckpoint(const string& fname)
+{
+  TCheckpoint cp;
+  SimulationParams saved = params;
+
+  assert(engine);
+
+  if (!cp.open(fname))
+    return false;
+
+  // The network must have been built for the very same parameters, see
+  // loadCheckpointParams()
+  getCheckpointParams(cp, saved);
+  if (!cp.ok() ||
+      saved.mesh_dim_x != params.mesh_dim_x || saved.mesh_dim_y != params.mesh_dim_y ||
+      saved.buffer_depth != params.buffer_depth || saved.disr != params.disr ||
+      saved.bootstrap != params.bootstrap || saved.rnd_generator_seed != params.rnd_generator_seed)
+    return false;
+
+  net->load(cp);
+  engine->load(cp);
+  restored = cp.ok();
+
+  return cp.close() && restored;
+}
+
+//---------------------------------------------------------------------------
+
+bool SimulationContext::loadCheckpointParams(const string& fname, SimulationParams& params)
+{
+  TCheckpoint cp;
+
+  if (!cp.open(fname))
+    return false;
+
+  getCheckpointParams(cp, params);
+
+  return cp.close();
+}
+
+//---------------------------------------------------------------------------
+
+double SimulationContext::getCurrentCycle() const
+{
+  if (engine)
+    return engine->current_cycle;
+
+  return sc_time_stamp().to_double()/1000 - systemc_cycle_offset;
+}
+
+//---------------------------------------------------------------------------
+
+void SimulationContext::setSystemCCycle(const double cycle)
+{
+  systemc_cycle_offset = sc_time_stamp().to_double()/1000 - cycle;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,103 @@
+/*****************************************************************************
+
+  SimulationContext.h -- Everything a single simulation owns
+
+ *****************************************************************************/
+#ifndef __SIMULATIONCONTEXT_H__
+#define __SIMULATIONCONTEXT_H__
+
+//---------------------------------------------------------------------------
+
+#include <systemc.h>
+#include <pthread.h>
+#include "nanoxim.h"
+#include "TRandom.h"
+#include "TNet.h"
+#include "TNativeEngine.h"
+#include "TLog.h"
+#include "TTrace.h"
+#include "TCheckpoint.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// SimulationContext -- owns the parameters, the random number generator
+// and the network of one simulation. Every module reaches it through its
+// owner (TNet::ctx, TRouter::ctx, ...), so nothing is shared between two
+// contexts and independent simulations can run concurrently, each on its
+// own thread.
+//
+// That only holds for the native engine: the SystemC kernel is a single
+// global one, so at most one context per process can use ENGINE_SYSTEMC.
+// The elaboration of the SystemC modules is serialized in any case.
+
+class SimulationContext
+{
+ public:
+
+  SimulationContext(const SimulationParams& _params);
+  ~SimulationContext();
+
+  // Elaborate the network (and the engine) for the current parameters
+  void build();
+
+  // Bring the network back to its just built state for a run with a
+  // new seed, see TNet::restart()
+  void restart(const int seed);
+
+  // Same as restart(), for a run with other parameters altogether. They
+  // must not change what the network was built for (see ForkServer),
+  // and the run counter is left alone
+  void reconfigure(const SimulationParams& _params);
+
+  // Reset the network and run it for simulation_time cycles, or until
+  // one of the stop conditions holds. Returns the reason for stopping
+  int simulate();
+
+  // Write the results file of the run just ended
+  void writeResults(const int stop_reason);
+
+  // Save the whole state of the network, between two cycles, to fname
+  // (native engine only, see TCheckpoint). False on I/O errors
+  bool saveCheckpoint(const string& fname) const;
+
+  // Bring the network just built to the state saved in fname: the next
+  // simulate() resumes from there instead of going through the reset
+  bool loadCheckpoint(const string& fname);
+
+  // Copy into params the ones a checkpoint was taken with, which the
+  // network must be built with to load it: the mesh, the buffers, the
+  // DiSR setup, the defects and the seed
+  static bool loadCheckpointParams(const string& fname, SimulationParams& params);
+
+  // Current simulation cycle, as seen by the running engine
+  double getCurrentCycle() const;
+
+  // Make the SystemC engine count cycles from 'cycle' at the current time
+  void setSystemCCycle(const double cycle);
+
+  SimulationParams     params;
+  TRandom              rng;
+  TNet*                net;
+  TNativeEngine*       engine;     // NULL when running under SystemC
+  TTrace*              trace;      // NULL unless tracing (-trace)
+  int                  run;        // Index of the current run, counted by restart()
+
+ private:
+
+  int                  id;         // Unique in the process, names the modules
+  bool                 restored;   // Loaded from a checkpoint, not to be reset
+  sc_clock*            clock;
+  sc_signal<bool>*     reset;
+
+  // SystemC time (in cycles) at which the current run began, as a run
+  // can not rewind the kernel time
+  double               systemc_cycle_offset;
+
+  static pthread_mutex_t elaboration_mutex;
+  static int           contexts;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
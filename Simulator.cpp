@@ -0,0 +1,34 @@
+/*****************************************************************************
+
+  Simulator.cpp -- Library interface of the simulator core
+
+ *****************************************************************************/
+#include "Simulator.h"
+#include "GlobalStats.h"
+
+//---------------------------------------------------------------------------
+
+Simulator::Simulator(const SimulationParams& params) : ctx(params)
+{
+  ctx.build();
+  restarted = false;
+}
+
+//---------------------------------------------------------------------------
+
+SimulationResults Simulator::run(const int seed)
+{
+  // The defects of the built network were drawn with the seed of params
+  if (restarted || seed != ctx.params.rnd_generator_seed)
+    ctx.restart(seed);
+  restarted = true;
+
+  int stop_reason = ctx.simulate();
+
+  GlobalStats gs(ctx.net);
+  gs.setStopCondition(stop_reason);
+
+  return gs.getResults();
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,45 @@
+/*****************************************************************************
+
+  Simulator.h -- Library interface of the simulator core
+
+ *****************************************************************************/
+#ifndef __SIMULATOR_H__
+#define __SIMULATOR_H__
+
+//---------------------------------------------------------------------------
+
+#include "nanoxim.h"
+#include "SimulationContext.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Simulator -- runs simulations in the calling process, for the tools
+// linking the simulator core (libnanoxim.a) instead of launching the
+// nanoxim binary. The network is elaborated once, by the constructor,
+// and restarted for every run after the first one, as with -runs.
+//
+// Each Simulator has a SimulationContext of its own, so that several
+// of them can run concurrently, one per thread, provided they use the
+// native engine. Nothing is printed to the results file.
+
+class Simulator
+{
+ public:
+
+  Simulator(const SimulationParams& params);
+
+  // Run the simulation with the given seed and return its results
+  SimulationResults run(const int seed);
+
+  const SimulationParams& getParams() const { return ctx.params; }
+
+ private:
+
+  SimulationContext ctx;
+  bool              restarted;  // The network is not as just built
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -150,10 +150,10 @@ double Stats::getCommunicationEnergy(int src_id, int dst_id)
 {
     // Assumptions: minimal path routing, constant packet size
 
+    /*
     TCoord src_coord = id2Coord(src_id);
     TCoord dst_coord = id2Coord(dst_id);
 
-    /*
     int hops =
 	abs(src_coord.x - dst_coord.x) + abs(src_coord.y - dst_coord.y);
 	*/
@@ -220,3 +220,35 @@ void Stats::showStats(int curr_node, std::ostream & out, bool header)
     out << "% Aggregated average throughput (packets/cycle): " <<
 	getAverageThroughput() << endl;
 }
+
+void Stats::save(TCheckpoint & cp) const
+{
+    cp.put(id);
+    cp.put(warm_up_time);
+    cp.put((uint32_t) chist.size());
+    for (unsigned int i = 0; i < chist.size(); i++) {
+	cp.put(chist[i].src_id);
+	cp.putVector(chist[i].delays);
+	cp.put(chist[i].total_received_flits);
+	cp.put(chist[i].last_received_flit_time);
+    }
+}
+
+void Stats::load(TCheckpoint & cp)
+{
+    uint32_t n;
+
+    cp.get(id);
+    cp.get(warm_up_time);
+    cp.get(n);
+    chist.clear();
+    for (unsigned int i = 0; i < n && cp.ok(); i++) {
+	CommHistory ch;
+
+	cp.get(ch.src_id);
+	cp.getVector(ch.delays);
+	cp.get(ch.total_received_flits);
+	cp.get(ch.last_received_flit_time);
+	chist.push_back(ch);
+    }
+}
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <vector>
 #include "nanoxim.h"
+#include "TCheckpoint.h"
 using namespace std;
 
 struct CommHistory {
@@ -62,6 +63,10 @@ class Stats {
     // average between the minimum and the maximum packet size).
     double getCommunicationEnergy(int src_id, int dst_id);
 
+    // Checkpoint of the collected history, see TCheckpoint
+    void save(TCheckpoint & cp) const;
+    void load(TCheckpoint & cp);
+
     // Shows statistics for the current node
     void showStats(int curr_node, std::ostream & out =
 		   std::cout, bool header = false);
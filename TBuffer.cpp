@@ -19,6 +19,9 @@ void TBuffer::SetMaxBufferSize(const unsigned int bms)
   assert(bms > 0);
 
   max_buffer_size = bms;
+  buffer.assign(bms, TPacket());
+  head = 0;
+  count = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -32,14 +35,14 @@ unsigned int TBuffer::GetMaxBufferSize() const
 
 bool TBuffer::IsFull() const
 {
-  return buffer.size() == max_buffer_size;
+  return count == max_buffer_size;
 }
 
 //---------------------------------------------------------------------------
 
 bool TBuffer::IsEmpty() const
 {
-  return buffer.size() == 0;
+  return count == 0;
 }
 
 //---------------------------------------------------------------------------
@@ -63,45 +66,56 @@ void TBuffer::Push(const TPacket& packet)
   if (IsFull())
     Drop(packet);
   else
-    buffer.push(packet);
+    {
+      unsigned int tail = head + count;
+
+      if (tail >= max_buffer_size)
+	tail -= max_buffer_size;
+
+      buffer[tail] = packet;
+      count++;
+    }
 }
 
 //---------------------------------------------------------------------------
 
-TPacket TBuffer::Pop()
+void TBuffer::Pop()
 {
-  TPacket f;
-
   if (IsEmpty())
     Empty();
   else
     {
-      f = buffer.front();
-      buffer.pop();
+      if (++head == max_buffer_size)
+	head = 0;
+      count--;
     }
-
-  return f;
 }
 
 //---------------------------------------------------------------------------
 
-TPacket TBuffer::Front() const
+TPacket& TBuffer::Front()
 {
-  TPacket f;
+  if (IsEmpty())
+    Empty();
 
+  return buffer[head];
+}
+
+//---------------------------------------------------------------------------
+
+const TPacket& TBuffer::Front() const
+{
   if (IsEmpty())
     Empty();
-  else
-    f = buffer.front();
 
-  return f;
+  return buffer[head];
 }
 
 //---------------------------------------------------------------------------
 
 unsigned int TBuffer::Size() const
 {
-  return buffer.size();
+  return count;
 }
 
 //---------------------------------------------------------------------------
@@ -110,3 +124,34 @@ unsigned int TBuffer::getCurrentFreeSlots() const
     return (GetMaxBufferSize()-Size());
 }
 //---------------------------------------------------------------------------
+
+void TBuffer::save(TCheckpoint& cp) const
+{
+  cp.put(count);
+  for (unsigned int i = 0; i < count; i++)
+    cp.put(buffer[(head + i) % max_buffer_size]);
+}
+
+//---------------------------------------------------------------------------
+
+void TBuffer::load(TCheckpoint& cp)
+{
+  unsigned int n;
+
+  head = 0;
+  count = 0;
+
+  cp.get(n);
+  for (unsigned int i = 0; i < n && cp.ok(); i++)
+    {
+      TPacket packet;
+
+      cp.get(packet);
+      if (IsFull())
+	cp.fail();  // Saved with a deeper buffer
+      else
+	Push(packet);
+    }
+}
+
+//---------------------------------------------------------------------------
@@ -28,12 +28,16 @@
 //---------------------------------------------------------------------------
 
 #include <cassert>
-#include <queue>
+#include <vector>
 #include "nanoxim.h"
+#include "TCheckpoint.h"
 
 using namespace std;
 
 //---------------------------------------------------------------------------
+// TBuffer -- fixed capacity FIFO of packets. Storage is a ring allocated
+// once by SetMaxBufferSize(), so pushing and popping never allocate and
+// the head packet can be accessed (and modified) in place.
 
 class TBuffer
 {
@@ -60,16 +64,24 @@ class TBuffer
   void Push(const TPacket& packet); // Push a packet. Calls Drop method if
 				// buffer is full.
 
-  TPacket Pop(); // Pop a packet.
+  void Pop(); // Remove the first packet. Calls Empty method if buffer is
+	      // empty.
 
-  TPacket Front() const; // Return a copy of the first packet in the buffer.
+  TPacket& Front(); // Return the first packet in the buffer (in place)
+  const TPacket& Front() const;
 
   unsigned int Size() const;
 
+  // Checkpoint of the stored packets, see TCheckpoint
+  void save(TCheckpoint& cp) const;
+  void load(TCheckpoint& cp);
+
 private:
   
   unsigned int max_buffer_size;
-  queue<TPacket> buffer;
+  vector<TPacket> buffer;       // Ring storage, max_buffer_size slots
+  unsigned int head;            // Slot of the first packet
+  unsigned int count;           // Number of stored packets
 };
 
 #endif
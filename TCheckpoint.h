@@ -0,0 +1,123 @@
+/*****************************************************************************
+
+  TCheckpoint.h -- Binary snapshot of a simulation
+
+ *****************************************************************************/
+#ifndef __TCHECKPOINT_H__
+#define __TCHECKPOINT_H__
+
+//---------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+#define CHECKPOINT_MAGIC       "NXCKPT"
+#define CHECKPOINT_VERSION     1
+
+// Sanity limit for the length of the vectors read back
+#define CHECKPOINT_MAX_ITEMS   (1 << 28)
+
+//---------------------------------------------------------------------------
+// TCheckpoint -- file a snapshot is written to or read from. Every module
+// with state has a save(TCheckpoint&) and a load(TCheckpoint&), which put
+// and get their fields in the same order. Values are raw bytes, in the
+// byte order of the machine: a snapshot is meant to be restored by the
+// same build of the simulator. I/O errors are sticky and reported by
+// close().
+
+class TCheckpoint
+{
+ public:
+
+  TCheckpoint() : fp(NULL), failed(false) {}
+  ~TCheckpoint() { close(); }
+
+  bool create(const string& fname)
+  {
+    fp = fopen(fname.c_str(), "wb");
+    return fp != NULL;
+  }
+
+  bool open(const string& fname)
+  {
+    fp = fopen(fname.c_str(), "rb");
+    return fp != NULL;
+  }
+
+  // False if anything failed since create()/open()
+  bool close()
+  {
+    if (fp != NULL && fclose(fp) != 0)
+      failed = true;
+    fp = NULL;
+
+    return !failed;
+  }
+
+  bool ok() const { return !failed; }
+
+  // For the loaders, when what is read does not fit
+  void fail() { failed = true; }
+
+  // Plain (trivially copyable) values
+  template <class T> void put(const T& value)
+  {
+    if (fwrite(&value, sizeof(T), 1, fp) != 1)
+      failed = true;
+  }
+
+  // What is left of a failed load is garbage, to be thrown away
+  template <class T> void get(T& value)
+  {
+    if (failed || fread(&value, sizeof(T), 1, fp) != 1)
+      failed = true;
+  }
+
+  template <class T> void putVector(const vector<T>& v)
+  {
+    put((uint32_t)v.size());
+    if (!v.empty() && fwrite(&v[0], sizeof(T), v.size(), fp) != v.size())
+      failed = true;
+  }
+
+  template <class T> void getVector(vector<T>& v)
+  {
+    uint32_t size;
+
+    get(size);
+    if (failed || size > CHECKPOINT_MAX_ITEMS)
+    {
+      v.clear();
+      failed = true;
+      return;
+    }
+
+    v.resize(size);
+    if (size > 0 && fread(&v[0], sizeof(T), size, fp) != size)
+      failed = true;
+  }
+
+  // For the fields that must match the ones already in place
+  template <class T> void expect(const T& value)
+  {
+    T read;
+
+    get(read);
+    if (memcmp(&read, &value, sizeof(T)) != 0)
+      failed = true;
+  }
+
+ private:
+
+  FILE *fp;
+  bool failed;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,132 @@
+/*****************************************************************************
+
+  TLink.h -- ABP channel shared by the SystemC and the native engine
+
+ *****************************************************************************/
+#ifndef __TLINK_H__
+#define __TLINK_H__
+
+//---------------------------------------------------------------------------
+
+#include <systemc.h>
+#include "nanoxim.h"
+#include "TCheckpoint.h"
+
+//---------------------------------------------------------------------------
+// TLink -- packet/req/ack triple of a single channel direction, as plain
+// fields. Writes are staged in the next_* fields and only become visible
+// after commit(), mirroring the evaluate/update semantics of sc_signal.
+//
+// Under the SystemC kernel a write requests an update, and update()
+// commits the link. The native engine calls detach() and commits the
+// links itself, one line at a time (see commitRequest/commitAck).
+class TLink : public sc_prim_channel
+{
+ public:
+
+  TPacket            packet;       // Current value of the packet line
+  bool               req;          // Current value of the request line
+  bool               ack;          // Current value of the ack line
+
+  TPacket            next_packet;  // Values written during this cycle
+  bool               next_req;
+  bool               next_ack;
+
+  TLink() : req(false), ack(false), next_req(false), next_ack(false), kernel(true) {}
+
+  // Back to the initial (all low) lines
+  inline void clear()
+  {
+    packet = next_packet = TPacket();
+    req = ack = next_req = next_ack = false;
+  }
+
+  // Commits are left to the caller from now on
+  inline void detach()
+  {
+    kernel = false;
+  }
+
+  // Sender side: a new packet along with its request level
+  inline void writeRequest(const TPacket& p, const bool level)
+  {
+    next_packet = p;
+    next_req = level;
+    if (kernel) request_update();
+  }
+
+  // Sender side: request level only
+  inline void writeRequest(const bool level)
+  {
+    next_req = level;
+    if (kernel) request_update();
+  }
+
+  // Receiver side
+  inline void writeAck(const bool level)
+  {
+    next_ack = level;
+    if (kernel) request_update();
+  }
+
+  inline void commit()
+  {
+    packet = next_packet;
+    req = next_req;
+    ack = next_ack;
+  }
+
+  // Commit only the lines driven by the sender. Returns true when the
+  // request toggled, i.e. the receiver has a new packet to look at
+  inline bool commitRequest()
+  {
+    bool toggled = (req != next_req);
+
+    packet = next_packet;
+    req = next_req;
+
+    return toggled;
+  }
+
+  // Commit only the line driven by the receiver
+  inline void commitAck()
+  {
+    ack = next_ack;
+  }
+
+  // Checkpoint of the lines, see TCheckpoint
+  void save(TCheckpoint& cp) const
+  {
+    cp.put(packet);
+    cp.put(req);
+    cp.put(ack);
+    cp.put(next_packet);
+    cp.put(next_req);
+    cp.put(next_ack);
+  }
+
+  void load(TCheckpoint& cp)
+  {
+    cp.get(packet);
+    cp.get(req);
+    cp.get(ack);
+    cp.get(next_packet);
+    cp.get(next_req);
+    cp.get(next_ack);
+  }
+
+ protected:
+
+  virtual void update()
+  {
+    commit();
+  }
+
+ private:
+
+  bool               kernel;       // Committed by the SystemC update phase
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,190 @@
+/*****************************************************************************
+
+  TLog.cpp -- Diagnostic log implementation
+
+ *****************************************************************************/
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "TLog.h"
+#include "SimulationContext.h"
+
+//---------------------------------------------------------------------------
+
+#define LOG_BUFFER_SIZE       65536
+#define LOG_FLUSH_THRESHOLD   (LOG_BUFFER_SIZE - 4096)   // Leave room for a whole record
+
+static int log_fd = STDOUT_FILENO;
+
+static const char *category_names[] = { "router", "disr", "pe", "net", "stats" };
+
+//---------------------------------------------------------------------------
+// TLogSink -- the buffer of a thread
+
+class TLogSink : public streambuf
+{
+ public:
+
+  TLogSink() : out(this)
+  {
+    setp(buffer, buffer + LOG_BUFFER_SIZE);
+  }
+
+  void flush()
+  {
+    const char *p = pbase();
+    size_t left = pptr() - pbase();
+
+    // Keep the order with what went through cout
+    if (left > 0 && log_fd == STDOUT_FILENO)
+      fflush(stdout);
+
+    while (left > 0)
+    {
+      ssize_t written = write(log_fd, p, left);
+
+      if (written < 0 && errno == EINTR)
+	continue;
+      if (written <= 0)
+	break;
+
+      p += written;
+      left -= written;
+    }
+
+    setp(buffer, buffer + LOG_BUFFER_SIZE);
+  }
+
+  // Only whole records are written out, if possible
+  void endRecord()
+  {
+    if (pptr() - pbase() > LOG_FLUSH_THRESHOLD)
+      flush();
+  }
+
+  ostream out;
+
+ protected:
+
+  int overflow(int c)
+  {
+    flush();
+
+    if (c != EOF)
+    {
+      *pptr() = c;
+      pbump(1);
+    }
+
+    return c == EOF ? 0 : c;
+  }
+
+ private:
+
+  char buffer[LOG_BUFFER_SIZE];
+};
+
+//---------------------------------------------------------------------------
+
+static pthread_key_t  sink_key;
+static pthread_once_t sink_key_once = PTHREAD_ONCE_INIT;
+
+static void deleteSink(void *sink)
+{
+  ((TLogSink *)sink)->flush();
+  delete (TLogSink *)sink;
+}
+
+static void createSinkKey()
+{
+  pthread_key_create(&sink_key, deleteSink);
+}
+
+static TLogSink* getSink(const bool create)
+{
+  pthread_once(&sink_key_once, createSinkKey);
+
+  TLogSink *sink = (TLogSink *)pthread_getspecific(sink_key);
+
+  if (sink == NULL && create)
+  {
+    sink = new TLogSink;
+    pthread_setspecific(sink_key, sink);
+  }
+
+  return sink;
+}
+
+//---------------------------------------------------------------------------
+
+bool TLog::open(const string& fname)
+{
+  int fd = ::open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+  if (fd < 0)
+    return false;
+
+  log_fd = fd;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+void TLog::flush()
+{
+  TLogSink *sink = getSink(false);
+
+  if (sink)
+    sink->flush();
+}
+
+//---------------------------------------------------------------------------
+
+int TLog::parseCategories(const string& list)
+{
+  istringstream iss(list);
+  string name;
+  int categories = 0;
+
+  while (getline(iss, name, ','))
+  {
+    int c;
+
+    for (c = 0; c < (int)(sizeof(category_names)/sizeof(category_names[0])); c++)
+      if (name == category_names[c])
+	break;
+
+    if (c == (int)(sizeof(category_names)/sizeof(category_names[0])))
+      return -1;
+
+    categories |= 1 << c;
+  }
+
+  return categories;
+}
+
+//---------------------------------------------------------------------------
+
+TLogRecord::TLogRecord(const SimulationContext *ctx, const int category) : out(getSink(true)->out)
+{
+  int c = 0;
+
+  while (!(category & (1 << c)))
+    c++;
+
+  out << ctx->getCurrentCycle() << " " << category_names[c] << " ";
+}
+
+//---------------------------------------------------------------------------
+
+TLogRecord::~TLogRecord()
+{
+  out << '\n';
+  ((TLogSink *)out.rdbuf())->endRecord();
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,92 @@
+/*****************************************************************************
+
+  TLog.h -- Diagnostic log
+
+ *****************************************************************************/
+#ifndef __TLOG_H__
+#define __TLOG_H__
+
+//---------------------------------------------------------------------------
+
+#include <ostream>
+#include <string>
+#include "nanoxim.h"
+
+using namespace std;
+
+class SimulationContext;
+
+// Log categories, selected with -log_categories
+#define LOG_ROUTER           0x01
+#define LOG_DISR             0x02
+#define LOG_PE               0x04
+#define LOG_NET              0x08     // Defect map
+#define LOG_STATS            0x10
+#define LOG_ALL              0x1f
+
+// Log levels: a record is kept when its level is up to the -verbose one
+#define LOG_WARNING          VERBOSE_LOW      // WARNING and CRITICAL conditions
+#define LOG_INFO             VERBOSE_MEDIUM   // Defects, bootstrap, segments set up, packets sent and received
+#define LOG_DEBUG            VERBOSE_HIGH     // Every router and DiSR step
+
+// Records compiled in, the others are dropped by the compiler. E.g.
+// OTHER="-DLOG_CATEGORIES=LOG_DISR -DLOG_MAX_LEVEL=LOG_WARNING"
+#ifndef LOG_CATEGORIES
+#define LOG_CATEGORIES       LOG_ALL
+#endif
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL        LOG_DEBUG
+#endif
+
+#define LOG_ENABLED(ctx, category, level)					\
+  (((category) & LOG_CATEGORIES) && (level) <= LOG_MAX_LEVEL &&			\
+   (level) <= (ctx)->params.verbose_mode && ((category) & (ctx)->params.log_categories))
+
+// LOG(ctx, LOG_DISR, LOG_DEBUG) << "..." << ...; writes a record, one
+// line. Nothing after LOG() is evaluated when the record is not enabled.
+// A single statement, safe as the body of an unbraced if/else
+#define LOG(ctx, category, level)					\
+  for (bool log_once = LOG_ENABLED(ctx, category, level); log_once; log_once = false) \
+    TLogRecord(ctx, category).stream()
+
+//---------------------------------------------------------------------------
+// TLog -- where the records go. Each thread formats its records into a
+// buffer of its own, written out with a single write() when full, when
+// the thread ends or on flush(). Records are whole lines, prefixed by
+// the cycle and the category, and those of a thread are never split
+// among writes unless longer than the buffer.
+
+class TLog
+{
+ public:
+
+  // Send the records to fname rather than to the standard output
+  static bool open(const string& fname);
+
+  // Write out the records buffered by the calling thread
+  static void flush();
+
+  // Categories in a comma separated list of names, -1 if any is unknown
+  static int parseCategories(const string& list);
+};
+
+//---------------------------------------------------------------------------
+// TLogRecord -- a record being written, see LOG()
+
+class TLogRecord
+{
+ public:
+
+  TLogRecord(const SimulationContext *ctx, const int category);
+  ~TLogRecord();
+
+  ostream& stream() { return out; }
+
+ private:
+
+  ostream& out;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,458 @@
+/*****************************************************************************
+
+  TNativeEngine.cpp -- Cycle-driven simulation kernel implementation
+
+ *****************************************************************************/
+#include "TNativeEngine.h"
+#include "SimulationContext.h"
+#include "TCheckpoint.h"
+
+//---------------------------------------------------------------------------
+
+TBarrier::TBarrier(const int _count)
+{
+    count = _count;
+    waiting = 0;
+    generation = 0;
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+//---------------------------------------------------------------------------
+
+TBarrier::~TBarrier()
+{
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------------------------------------------------
+
+void TBarrier::wait()
+{
+    pthread_mutex_lock(&mutex);
+
+    unsigned int my_generation = generation;
+
+    if (++waiting == count)
+    {
+	waiting = 0;
+	generation++;
+	pthread_cond_broadcast(&cond);
+    }
+    else
+	while (my_generation == generation)
+	    pthread_cond_wait(&cond, &mutex);
+
+    pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------------------------------------------------
+
+TNativeEngine::TNativeEngine(TNet * _net) : stop_conditions(_net)
+{
+    net = _net;
+    current_cycle = 0;
+    barrier = NULL;
+    cycles_to_run = 0;
+
+    links = net->links;
+    links_count = net->t.size() * LINKS_PER_NODE;
+
+    // The links are committed by the engine, not by the SystemC kernel
+    for (int i = 0; i < links_count; i++)
+	links[i].detach();
+
+    for (unsigned int id = 0; id < net->t.size(); id++)
+    {
+	net->t[id]->r->native = true;
+	net->t[id]->pe->native = true;
+    }
+
+    const SimulationParams& params = net->ctx->params;
+
+    // Split the mesh in stripes of whole rows, one for each thread
+    int nthreads = min(params.threads, params.mesh_dim_y);
+    int first_row = 0;
+
+    node_partition.resize(net->t.size());
+
+    for (int p = 0; p < nthreads; p++)
+    {
+	int rows = params.mesh_dim_y / nthreads + (p < params.mesh_dim_y % nthreads ? 1 : 0);
+	TPartition partition;
+
+	partition.first_node = first_row * params.mesh_dim_x;
+	partition.last_node = (first_row + rows) * params.mesh_dim_x - 1;
+	partition.wakeups.resize(nthreads);
+	partitions.push_back(partition);
+
+	for (int id = partition.first_node; id <= partition.last_node; id++)
+	    node_partition[id] = p;
+
+	first_row += rows;
+    }
+
+    scheduled.resize(net->t.size(), 0);
+    last_evaluated.resize(net->t.size(), 0);
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::setReset(const bool level)
+{
+    for (unsigned int id = 0; id < net->t.size(); id++)
+    {
+	net->t[id]->r->native_reset = level;
+	net->t[id]->pe->native_reset = level;
+    }
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::reset()
+{
+    current_cycle = 0;
+
+    setReset(true);
+    for (unsigned int id = 0; id < net->t.size(); id++)
+	evaluateNode(id);
+    for (int i = 0; i < links_count; i++)
+	links[i].commit();
+    setReset(false);
+
+    current_cycle = DEFAULT_RESET_TIME;
+
+    // Everybody is evaluated at the first cycle, then idle nodes drop out
+    for (unsigned int p = 0; p < partitions.size(); p++)
+    {
+	partitions[p].active.clear();
+	partitions[p].next_active.clear();
+	partitions[p].quiet_cycles = 0;
+	partitions[p].covered_nodes = 0;
+	for (unsigned int q = 0; q < partitions.size(); q++)
+	    partitions[p].wakeups[q].clear();
+
+	for (int id = partitions[p].first_node; id <= partitions[p].last_node; id++)
+	{
+	    scheduled[id] = 1;
+	    last_evaluated[id] = (int)current_cycle - 1;
+	    if (net->t[id]->r->disr.isAssigned())
+		partitions[p].covered_nodes++;
+	    partitions[p].next_active.push_back(id);
+	}
+    }
+}
+
+//---------------------------------------------------------------------------
+
+int TNativeEngine::run(const int cycles)
+{
+    cycles_to_run = cycles;
+    stop_reason = STOP_NONE;
+    stop_conditions.start();
+
+    if (partitions.size() == 1)
+    {
+	work(0);
+	return stop_reason == STOP_NONE ? STOP_SIMULATION_TIME : stop_reason;
+    }
+
+    barrier = new TBarrier(partitions.size());
+
+    vector<pthread_t> threads(partitions.size());
+    vector<TWorker> workers(partitions.size());
+
+    for (unsigned int p = 1; p < partitions.size(); p++)
+    {
+	workers[p].engine = this;
+	workers[p].partition = p;
+	int rc = pthread_create(&threads[p], NULL, workerEntry, &workers[p]);
+	assert(rc == 0);
+    }
+
+    // The calling thread takes care of the first stripe
+    work(0);
+
+    for (unsigned int p = 1; p < partitions.size(); p++)
+	pthread_join(threads[p], NULL);
+
+    delete barrier;
+    barrier = NULL;
+
+    return stop_reason == STOP_NONE ? STOP_SIMULATION_TIME : stop_reason;
+}
+
+//---------------------------------------------------------------------------
+
+void* TNativeEngine::workerEntry(void *arg)
+{
+    TWorker *worker = (TWorker *)arg;
+
+    worker->engine->work(worker->partition);
+
+    return NULL;
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::work(const int partition)
+{
+    for (int c = 0; c < cycles_to_run; c++)
+    {
+	evaluate(partition);
+
+	if (barrier)
+	    barrier->wait();
+
+	// Every stripe computes the same value out of the quiet_cycles
+	// published before the barrier
+	int skip = cyclesToSkip(cycles_to_run - c - 1);
+
+	// Nobody reads the current cycle during the commit phase. A run
+	// that has to stop is not fast-forwarded
+	if (partition == 0)
+	{
+	    if (stop_conditions.enabled())
+		stop_reason = checkStop();
+
+	    current_cycle += 1 + (stop_reason == STOP_NONE ? skip : 0);
+	}
+
+	commit(partition);
+
+	if (barrier)
+	    barrier->wait();
+
+	if (stop_reason != STOP_NONE)
+	    break;
+
+	if (skip > 0)
+	{
+	    TPartition& p = partitions[partition];
+
+	    // Only countdown nodes are left, let them age as if evaluated
+	    for (unsigned int i = 0; i < p.next_active.size(); i++)
+		net->t[p.next_active[i]]->r->disr.skipCycles(skip);
+
+	    c += skip;
+	}
+    }
+}
+
+//---------------------------------------------------------------------------
+
+int TNativeEngine::checkStop() const
+{
+    bool quiescent = true;
+    int covered_nodes = 0;
+
+    for (unsigned int p = 0; p < partitions.size(); p++)
+    {
+	quiescent = quiescent && partitions[p].quiet_cycles == INT_MAX;
+	covered_nodes += partitions[p].covered_nodes;
+    }
+
+    return stop_conditions.check(quiescent, covered_nodes);
+}
+
+//---------------------------------------------------------------------------
+
+int TNativeEngine::cyclesToSkip(const int remaining) const
+{
+    int skip = remaining;
+
+    for (unsigned int p = 0; p < partitions.size(); p++)
+	skip = min(skip, partitions[p].quiet_cycles);
+
+    return skip;
+}
+
+//---------------------------------------------------------------------------
+
+bool TNativeEngine::requestPending(const int id) const
+{
+    TRouter *r = net->t[id]->r;
+    TProcessingElement *pe = net->t[id]->pe;
+
+    for (int d = 0; d < DIRECTIONS+1; d++)
+	if (r->link_tx[d]->next_req != r->link_tx[d]->req)
+	    return true;
+
+    return pe->link_tx->next_req != pe->link_tx->req;
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::schedule(const int id, const int partition)
+{
+    int owner = node_partition[id];
+
+    if (owner != partition)
+	partitions[partition].wakeups[owner].push_back(id);
+    else if (!scheduled[id])
+    {
+	scheduled[id] = 1;
+	partitions[partition].next_active.push_back(id);
+    }
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::evaluateNode(const int id)
+{
+    TNode *node = net->t[id];
+
+    node->r->txProcess();
+    node->r->rxProcess();
+    node->pe->txProcess();
+    node->pe->rxProcess();
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::evaluate(const int partition)
+{
+    TPartition& p = partitions[partition];
+    int cycle = (int)current_cycle;
+
+    // Collect the wakeups raised by the other stripes during the last
+    // commit phase (they won't touch them again before the next one)
+    for (unsigned int q = 0; q < partitions.size(); q++)
+    {
+	vector<int>& wakeups = partitions[q].wakeups[partition];
+
+	for (unsigned int i = 0; i < wakeups.size(); i++)
+	    schedule(wakeups[i], partition);
+	wakeups.clear();
+    }
+
+    // Keep the evaluation (and thus the log) in node order
+    p.active.swap(p.next_active);
+    p.next_active.clear();
+    sort(p.active.begin(), p.active.end());
+
+    p.quiet_cycles = INT_MAX;
+
+    for (unsigned int i = 0; i < p.active.size(); i++)
+    {
+	int id = p.active[i];
+	TNode *node = net->t[id];
+
+	scheduled[id] = 0;
+
+	// An idle txProcess just moves on the round robin pointer
+	node->r->start_from_port += cycle - last_evaluated[id] - 1;
+	last_evaluated[id] = cycle;
+
+	bool was_assigned = node->r->disr.isAssigned();
+
+	evaluateNode(id);
+
+	p.covered_nodes += (int)node->r->disr.isAssigned() - (int)was_assigned;
+
+	// A request toggled in this cycle wakes somebody up at the next one
+	int quiet = 0;
+	if (node->pe->isIdle() && !requestPending(id))
+	    quiet = node->r->idleCycles();
+
+	if (quiet != INT_MAX)
+	    schedule(id, partition);
+
+	p.quiet_cycles = min(p.quiet_cycles, quiet);
+    }
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::commitNode(const int id, const int partition)
+{
+    TRouter *r = net->t[id]->r;
+    TLink *base = &links[net->linkIndex(id, 0)];
+
+    // Each line is committed by the node driving it, so that stripes
+    // never commit the same field
+    for (int d = 0; d < DIRECTIONS; d++)
+    {
+	base[d].commitAck();
+
+	if (r->link_tx[d]->commitRequest())
+	    schedule((r->link_tx[d] - links) / LINKS_PER_NODE, partition);
+    }
+
+    base[LINK_TO_PE].commitAck();
+    base[LINK_FROM_PE].commitAck();
+    bool to_pe = base[LINK_TO_PE].commitRequest();
+    bool from_pe = base[LINK_FROM_PE].commitRequest();
+
+    if (to_pe || from_pe)
+	schedule(id, partition);
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::commit(const int partition)
+{
+    TPartition& p = partitions[partition];
+
+    for (unsigned int i = 0; i < p.active.size(); i++)
+	commitNode(p.active[i], partition);
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::save(TCheckpoint& cp) const
+{
+    // The nodes due at the next cycle, whichever stripe has them queued
+    vector<char> pending(scheduled);
+
+    for (unsigned int p = 0; p < partitions.size(); p++)
+	for (unsigned int q = 0; q < partitions.size(); q++)
+	    for (unsigned int i = 0; i < partitions[p].wakeups[q].size(); i++)
+		pending[partitions[p].wakeups[q][i]] = 1;
+
+    cp.put(current_cycle);
+    cp.putVector(last_evaluated);
+    cp.putVector(pending);
+}
+
+//---------------------------------------------------------------------------
+
+void TNativeEngine::load(TCheckpoint& cp)
+{
+    vector<char> pending;
+
+    cp.get(current_cycle);
+    cp.getVector(last_evaluated);
+    cp.getVector(pending);
+
+    if (last_evaluated.size() != net->t.size() || pending.size() != net->t.size())
+    {
+	cp.fail();
+	return;
+    }
+
+    // The reset line is left low, as after reset()
+    setReset(false);
+
+    for (unsigned int p = 0; p < partitions.size(); p++)
+    {
+	partitions[p].active.clear();
+	partitions[p].next_active.clear();
+	partitions[p].quiet_cycles = 0;
+	partitions[p].covered_nodes = 0;
+	for (unsigned int q = 0; q < partitions.size(); q++)
+	    partitions[p].wakeups[q].clear();
+
+	for (int id = partitions[p].first_node; id <= partitions[p].last_node; id++)
+	{
+	    scheduled[id] = pending[id];
+	    if (pending[id])
+		partitions[p].next_active.push_back(id);
+	    if (net->t[id]->r->disr.isAssigned())
+		partitions[p].covered_nodes++;
+	}
+    }
+}
+
+//---------------------------------------------------------------------------
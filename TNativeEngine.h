@@ -0,0 +1,138 @@
+/*****************************************************************************
+
+  TNativeEngine.h -- Cycle-driven simulation kernel (SystemC-free)
+
+ *****************************************************************************/
+#ifndef __TNATIVEENGINE_H__
+#define __TNATIVEENGINE_H__
+
+//---------------------------------------------------------------------------
+
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include "TNet.h"
+#include "TLink.h"
+#include "TStopConditions.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// TBarrier -- reusable barrier for the worker threads (pthread_barrier_t
+// is not available everywhere, e.g. on macosx)
+
+class TBarrier
+{
+ public:
+
+  TBarrier(const int _count);
+  ~TBarrier();
+
+  void wait();
+
+ private:
+
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int count;
+  int waiting;
+  unsigned int generation;
+};
+
+//---------------------------------------------------------------------------
+// TNativeEngine -- drives the very same TRouter/TProcessingElement
+// processes of a TNet with a plain two-phase loop: every cycle all the
+// processes are evaluated (txProcess before rxProcess, as the SystemC
+// kernel triggers statically sensitive methods in reverse registration
+// order) and then all the links are committed, which plays the role of
+// the sc_signal update phase.
+//
+// With SimulationParams::threads > 1 the mesh is split in stripes of whole
+// rows, each one evaluated and committed by its own thread. A barrier
+// separates the two phases, so a thread only ever sees the values its
+// neighbors committed in the previous cycle and the outcome does not
+// depend on the number of threads.
+//
+// Only the active nodes are evaluated: a node stays active while
+// TRouter::isIdle() or TProcessingElement::isIdle() says there is
+// something to do, and is woken up whenever one of its input requests
+// toggles. Evaluating an idle node would only advance start_from_port,
+// which is caught up when the node wakes again.
+//
+// When no packet is in flight and the only pending work is a DiSR
+// bootstrap countdown, the engine jumps straight to the cycle at which
+// the first timeout fires.
+
+class TNativeEngine
+{
+ public:
+
+  TNativeEngine(TNet * _net);
+
+  // Drive the reset line. All the reset branches are idempotent, so a
+  // single evaluation leaves the network as DEFAULT_RESET_TIME would
+  void reset();
+
+  // Run for the specified number of cycles, or until one of the stop
+  // conditions holds. Returns the reason for stopping
+  int run(const int cycles);
+
+  // Checkpoint of the engine state between two cycles, see TCheckpoint.
+  // A snapshot can be loaded with any number of threads
+  void save(TCheckpoint& cp) const;
+  void load(TCheckpoint& cp);
+
+  // Cycle being evaluated, see SimulationContext::getCurrentCycle()
+  double current_cycle;
+
+ private:
+
+  struct TPartition
+  {
+    int first_node;
+    int last_node;
+
+    vector<int> active;             // Nodes to evaluate in this cycle
+    vector<int> next_active;        // Nodes to evaluate in the next cycle
+    vector<vector<int> > wakeups;   // Nodes of other partitions to wake, by partition
+    int quiet_cycles;               // Upcoming cycles with nothing but timer countdowns
+    int covered_nodes;              // Nodes assigned to a segment
+  };
+
+  struct TWorker
+  {
+    TNativeEngine *engine;
+    int partition;
+  };
+
+  void setReset(const bool level);
+  void evaluateNode(const int id);
+  void commitNode(const int id, const int partition);
+  void schedule(const int id, const int partition);
+  void evaluate(const int partition);
+  void commit(const int partition);
+  void work(const int partition);
+  int cyclesToSkip(const int remaining) const;
+  int checkStop() const;
+  bool requestPending(const int id) const;
+  static void* workerEntry(void *arg);
+
+  TNet *net;
+
+  vector<TPartition> partitions;
+  vector<int> node_partition;       // Partition owning each node
+  vector<char> scheduled;           // Node already in its next_active list
+  vector<int> last_evaluated;       // Last cycle each node was evaluated at
+  TBarrier *barrier;
+  int cycles_to_run;
+  TStopConditions stop_conditions;
+  int stop_reason;
+
+  // The channels of the net, see TNet::links
+  TLink *links;
+  int links_count;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -5,148 +5,158 @@
  *****************************************************************************/
 #include "TNet.h"
 #include "Stats.h"
+#include "SimulationContext.h"
+#include "TCheckpoint.h"
 
 //---------------------------------------------------------------------------
 
 void TNet::buildMesh()
 {
 
+    const SimulationParams& params = ctx->params;
+    int nodes = params.mesh_dim_x * params.mesh_dim_y;
+
+    mesh_dim_x = params.mesh_dim_x;
+
+    links = new TLink[nodes * LINKS_PER_NODE];
+
+    t.resize(nodes);
+
     // Create the mesh as a matrix of nodes
-    for(int i=0; i<GlobalParams::mesh_dim_x; i++)
+    for(int i=0; i<params.mesh_dim_x; i++)
     {
-	for(int j=0; j<GlobalParams::mesh_dim_y; j++)
+	for(int j=0; j<params.mesh_dim_y; j++)
 	{
+	    int id = j * params.mesh_dim_x + i;
+
 	    // Create the single Node with a proper name
-	    char node_name[20];
+	    char node_name[32];
 	    sprintf(node_name, "Node[%02d][%02d]", i, j);
-	    t[i][j] = new TNode(node_name);
+	    t[id] = new TNode(node_name, ctx);
 
-	    t[i][j]->valid = true;
+	    t[id]->valid = true;
 
 	    // Tell to the router its coordinates
-	    t[i][j]->r->configure(j * GlobalParams::mesh_dim_x + i, GlobalParams::buffer_depth);
+	    t[id]->r->configure(id, params.buffer_depth);
 
 	    // Tell to the PE its coordinates
-	    t[i][j]->pe->local_id = j * GlobalParams::mesh_dim_x + i;
+	    t[id]->pe->local_id = id;
 
 	    // Map clock and reset
-	    t[i][j]->clock(clock);
-	    t[i][j]->reset(reset);
-
-	    // Map Rx signals
-	    t[i][j]->req_rx[DIRECTION_NORTH](req_to_south[i][j]);
-	    t[i][j]->packet_rx[DIRECTION_NORTH](packet_to_south[i][j]);
-	    t[i][j]->ack_rx[DIRECTION_NORTH](ack_to_north[i][j]);
-
-	    t[i][j]->req_rx[DIRECTION_EAST](req_to_west[i+1][j]);
-	    t[i][j]->packet_rx[DIRECTION_EAST](packet_to_west[i+1][j]);
-	    t[i][j]->ack_rx[DIRECTION_EAST](ack_to_east[i+1][j]);
-
-	    t[i][j]->req_rx[DIRECTION_SOUTH](req_to_north[i][j+1]);
-	    t[i][j]->packet_rx[DIRECTION_SOUTH](packet_to_north[i][j+1]);
-	    t[i][j]->ack_rx[DIRECTION_SOUTH](ack_to_south[i][j+1]);
-
-	    t[i][j]->req_rx[DIRECTION_WEST](req_to_east[i][j]);
-	    t[i][j]->packet_rx[DIRECTION_WEST](packet_to_east[i][j]);
-	    t[i][j]->ack_rx[DIRECTION_WEST](ack_to_west[i][j]);
-
-	    // Map Tx signals
-	    t[i][j]->req_tx[DIRECTION_NORTH](req_to_north[i][j]);
-	    t[i][j]->packet_tx[DIRECTION_NORTH](packet_to_north[i][j]);
-	    t[i][j]->ack_tx[DIRECTION_NORTH](ack_to_south[i][j]);
-
-	    t[i][j]->req_tx[DIRECTION_EAST](req_to_east[i+1][j]);
-	    t[i][j]->packet_tx[DIRECTION_EAST](packet_to_east[i+1][j]);
-	    t[i][j]->ack_tx[DIRECTION_EAST](ack_to_west[i+1][j]);
-
-	    t[i][j]->req_tx[DIRECTION_SOUTH](req_to_south[i][j+1]);
-	    t[i][j]->packet_tx[DIRECTION_SOUTH](packet_to_south[i][j+1]);
-	    t[i][j]->ack_tx[DIRECTION_SOUTH](ack_to_north[i][j+1]);
-
-	    t[i][j]->req_tx[DIRECTION_WEST](req_to_west[i][j]);
-	    t[i][j]->packet_tx[DIRECTION_WEST](packet_to_west[i][j]);
-	    t[i][j]->ack_tx[DIRECTION_WEST](ack_to_east[i][j]);
+	    t[id]->clock(clock);
+	    t[id]->reset(reset);
 	}
     }
 
-    // Clear signals for borderline nodes
-    for(int i=0; i<=GlobalParams::mesh_dim_x; i++)
+    // Bind the channels. Output channels towards the mesh boundary are
+    // looped back onto the node's own input of the same direction: those
+    // directions are invalidated below, so they never toggle.
+    for(int id=0; id<nodes; id++)
     {
-	req_to_south[i][0] = 0;
-	ack_to_north[i][0] = 0;
-	req_to_north[i][GlobalParams::mesh_dim_y] = 0;
-	ack_to_south[i][GlobalParams::mesh_dim_y] = 0;
+	TRouter *r = t[id]->r;
+	TProcessingElement *pe = t[id]->pe;
+
+	for(int d=0; d<DIRECTIONS; d++)
+	{
+	    int in = linkIndex(id, d);
+	    int neighbor_id = r->getNeighborId(id, d);
+	    int out = (neighbor_id == NOT_VALID) ? in : linkIndex(neighbor_id, (d + 2) % DIRECTIONS);
+
+	    r->link_rx[d] = &links[in];
+	    r->link_tx[d] = &links[out];
+	}
 
+	r->link_tx[DIRECTION_LOCAL] = &links[linkIndex(id, LINK_TO_PE)];
+	r->link_rx[DIRECTION_LOCAL] = &links[linkIndex(id, LINK_FROM_PE)];
+	pe->link_rx = &links[linkIndex(id, LINK_TO_PE)];
+	pe->link_tx = &links[linkIndex(id, LINK_FROM_PE)];
     }
 
-    for(int j=0; j<=GlobalParams::mesh_dim_y; j++)
-    {
-	req_to_east[0][j] = 0;
-	ack_to_west[0][j] = 0;
-	req_to_west[GlobalParams::mesh_dim_x][j] = 0;
-	ack_to_east[GlobalParams::mesh_dim_x][j] = 0;
+    applyDefects();
+}
+
+//---------------------------------------------------------------------------
+
+TNet::~TNet()
+{
+    for (unsigned int id=0; id<t.size(); id++)
+	delete t[id];
+
+    delete [] links;
+}
 
+//---------------------------------------------------------------------------
+
+void TNet::restart()
+{
+    for (unsigned int id=0; id<t.size(); id++)
+    {
+	t[id]->valid = true;
+	t[id]->r->restart();
+	t[id]->pe->packet_queue = queue<TPacket>();
     }
 
+    for (unsigned int i=0; i<t.size() * LINKS_PER_NODE; i++)
+	links[i].clear();
+
+    applyDefects();
+}
+
+//---------------------------------------------------------------------------
+
+void TNet::applyDefects()
+{
+    const SimulationParams& params = ctx->params;
+
     // invalidate reservation table and disr entries for non-exhistent channels
-    for(int i=0; i<GlobalParams::mesh_dim_x; i++)
+    for(int i=0; i<params.mesh_dim_x; i++)
     {
-	t[i][0]->r->reservation_table.invalidate(DIRECTION_NORTH);
-	t[i][GlobalParams::mesh_dim_y-1]->r->reservation_table.invalidate(DIRECTION_SOUTH);
+	getNode(i, 0)->r->reservation_table.invalidate(DIRECTION_NORTH);
+	getNode(i, params.mesh_dim_y-1)->r->reservation_table.invalidate(DIRECTION_SOUTH);
 
 	// disr
-	t[i][0]->r->disr.invalidate_direction(DIRECTION_NORTH);
-	t[i][GlobalParams::mesh_dim_y-1]->r->disr.invalidate_direction(DIRECTION_SOUTH);
+	getNode(i, 0)->r->disr.invalidate_direction(DIRECTION_NORTH);
+	getNode(i, params.mesh_dim_y-1)->r->disr.invalidate_direction(DIRECTION_SOUTH);
     }
-    for(int j=0; j<GlobalParams::mesh_dim_y; j++)
+    for(int j=0; j<params.mesh_dim_y; j++)
     {
-	t[0][j]->r->reservation_table.invalidate(DIRECTION_WEST);
-	t[GlobalParams::mesh_dim_x-1][j]->r->reservation_table.invalidate(DIRECTION_EAST);
+	getNode(0, j)->r->reservation_table.invalidate(DIRECTION_WEST);
+	getNode(params.mesh_dim_x-1, j)->r->reservation_table.invalidate(DIRECTION_EAST);
 
 	// disr
-	t[0][j]->r->disr.invalidate_direction(DIRECTION_WEST);
-	t[GlobalParams::mesh_dim_x-1][j]->r->disr.invalidate_direction(DIRECTION_EAST);
+	getNode(0, j)->r->disr.invalidate_direction(DIRECTION_WEST);
+	getNode(params.mesh_dim_x-1, j)->r->disr.invalidate_direction(DIRECTION_EAST);
     }
 
 
-    /* the first random number is flawed.... */
-    double rnd = (double)rand();
-    double test_ran = (rnd) / RAND_MAX;
-    cout << " --> RAND_MAX " << RAND_MAX << endl;
-    cout << " --> rnd " << rnd << endl;
-    cout << " --> test_ran " << test_ran << endl;
-
     // TODO: move as cmdline option chech
-    assert( !(GlobalParams::defective_links && GlobalParams::defective_nodes) );
+    assert( !(params.defective_links && params.defective_nodes) );
     //
     // invalidate reservation table and disr entries for defective nodes
-    if (GlobalParams::defective_nodes)
+    if (params.defective_nodes)
     {
 
-	for (int i=0; i<GlobalParams::mesh_dim_y; i++)
+	for (int i=0; i<params.mesh_dim_y; i++)
 	{
-	    for (int j=0; j<GlobalParams::mesh_dim_x; j++)
+	    for (int j=0; j<params.mesh_dim_x; j++)
 	    {
 		bool do_defect = false;
-		int node_id = t[j][i]->r->local_id;
-		int bootstrap_id =GlobalParams::bootstrap;
+		int node_id = getNode(j, i)->r->local_id;
+		int bootstrap_id =params.bootstrap;
 
-#ifdef VERBOSE
-		cout << "Analyzing node " << node_id;
-#endif
-		double ran = ((double) rand()) / RAND_MAX;
-		//cout << " --> ran " << ran << endl;
+		double ran = ctx->rng.uniform(node_id, RANDOM_STREAM_NODE_DEFECT, 0);
+		LOG(ctx, LOG_NET, LOG_DEBUG) << "Analyzing node " << node_id << " --> ran " << ran;
 
 		// if defect happens...
-		if ( ran < GlobalParams::defective_nodes)
+		if ( ran < params.defective_nodes)
 		{
 		    do_defect = true;
 		    // and if there's immunity...
-		    if (GlobalParams::bootstrap_immunity)
+		    if (params.bootstrap_immunity)
 		    {
 			// disable defect if any neighbor (or the node itself) is bootstrap
 			for (int d=0;d<DIRECTIONS;d++)
-			    if (t[j][i]->r->getNeighborId(node_id,d) == bootstrap_id)
+			    if (getNode(j, i)->r->getNeighborId(node_id,d) == bootstrap_id)
 				do_defect = false;
 
 			if (node_id==bootstrap_id) do_defect = false;
@@ -155,10 +165,8 @@ void TNet::buildMesh()
 
 		if (do_defect)
 		{
-#ifdef VERBOSE
-		    cout << " found node defect " << endl;
-#endif
-		    t[j][i]->valid = false;
+		    LOG(ctx, LOG_NET, LOG_INFO) << "found node defect " << node_id;
+		    getNode(j, i)->valid = false;
 
 		    // NORTH link
 		    
@@ -166,43 +174,43 @@ void TNet::buildMesh()
 		    // all this stuff makes no sense because direction doesn't exhists
 		    //
 		    if (i>0) {
-			    t[j][i]->r->disr.invalidate_direction(DIRECTION_NORTH);
-			    t[j][i]->r->reservation_table.invalidate(DIRECTION_NORTH);
-			    t[j][i-1]->r->disr.invalidate_direction(DIRECTION_SOUTH);
-			    t[j][i-1]->r->reservation_table.invalidate(DIRECTION_SOUTH);
+			    getNode(j, i)->r->disr.invalidate_direction(DIRECTION_NORTH);
+			    getNode(j, i)->r->reservation_table.invalidate(DIRECTION_NORTH);
+			    getNode(j, i-1)->r->disr.invalidate_direction(DIRECTION_SOUTH);
+			    getNode(j, i-1)->r->reservation_table.invalidate(DIRECTION_SOUTH);
 		    }
 
 		    // EAST link
 
 		    // not too right
-		    if (j<GlobalParams::mesh_dim_x-1)
+		    if (j<params.mesh_dim_x-1)
 		    {
-			    t[j+1][i]->r->disr.invalidate_direction(DIRECTION_WEST);
-			    t[j+1][i]->r->reservation_table.invalidate(DIRECTION_WEST);
+			    getNode(j+1, i)->r->disr.invalidate_direction(DIRECTION_WEST);
+			    getNode(j+1, i)->r->reservation_table.invalidate(DIRECTION_WEST);
 
-			    t[j][i]->r->disr.invalidate_direction(DIRECTION_EAST);
-			    t[j][i]->r->reservation_table.invalidate(DIRECTION_EAST);
+			    getNode(j, i)->r->disr.invalidate_direction(DIRECTION_EAST);
+			    getNode(j, i)->r->reservation_table.invalidate(DIRECTION_EAST);
 
 		    }
 
 		    // SOUTH LINK
-		    if (i<GlobalParams::mesh_dim_y-1)
+		    if (i<params.mesh_dim_y-1)
 		    {
-			    t[j][i]->r->disr.invalidate_direction(DIRECTION_SOUTH);
-			    t[j][i]->r->reservation_table.invalidate(DIRECTION_SOUTH);
+			    getNode(j, i)->r->disr.invalidate_direction(DIRECTION_SOUTH);
+			    getNode(j, i)->r->reservation_table.invalidate(DIRECTION_SOUTH);
 
-			    t[j][i+1]->r->disr.invalidate_direction(DIRECTION_NORTH);
-			    t[j][i+1]->r->reservation_table.invalidate(DIRECTION_NORTH);
+			    getNode(j, i+1)->r->disr.invalidate_direction(DIRECTION_NORTH);
+			    getNode(j, i+1)->r->reservation_table.invalidate(DIRECTION_NORTH);
 		    }
 
 		    // WEST link
 		    if (j>0)
 		    {
-			    t[j][i]->r->disr.invalidate_direction(DIRECTION_WEST);
-			    t[j][i]->r->reservation_table.invalidate(DIRECTION_WEST);
+			    getNode(j, i)->r->disr.invalidate_direction(DIRECTION_WEST);
+			    getNode(j, i)->r->reservation_table.invalidate(DIRECTION_WEST);
 
-			    t[j-1][i]->r->disr.invalidate_direction(DIRECTION_EAST);
-			    t[j-1][i]->r->reservation_table.invalidate(DIRECTION_EAST);
+			    getNode(j-1, i)->r->disr.invalidate_direction(DIRECTION_EAST);
+			    getNode(j-1, i)->r->reservation_table.invalidate(DIRECTION_EAST);
 		    }
 
 
@@ -213,57 +221,49 @@ void TNet::buildMesh()
     } // defective_nodes
 
     // invalidate reservation table and disr entries for defective channels
-    if (GlobalParams::defective_links)
+    if (params.defective_links)
     {
 	bool do_defect;
 
-	for (int i=0; i<GlobalParams::mesh_dim_y; i++)
+	for (int i=0; i<params.mesh_dim_y; i++)
 	{
-	    for (int j=0; j<GlobalParams::mesh_dim_x-1; j++)
+	    for (int j=0; j<params.mesh_dim_x-1; j++)
 	    {
-		int node_id = t[j][i]->r->local_id;
-#ifdef VERBOSE
-		cout << "Analyzing horizonal links, node " << node_id;
-#endif
-		double ran = ((double) rand()) / RAND_MAX;
-		cout << " --> ran " << ran << endl;
-		do_defect = ( ran < GlobalParams::defective_links);
-		bool no_bootstrap_link = (node_id!=GlobalParams::bootstrap && (node_id+1)!=GlobalParams::bootstrap);
-
-		if (do_defect && (no_bootstrap_link || !GlobalParams::bootstrap_immunity) )
+		int node_id = getNode(j, i)->r->local_id;
+		double ran = ctx->rng.uniform(node_id, RANDOM_STREAM_LINK_EAST, 0);
+		LOG(ctx, LOG_NET, LOG_DEBUG) << "Analyzing horizonal links, node " << node_id << " --> ran " << ran;
+		do_defect = ( ran < params.defective_links);
+		bool no_bootstrap_link = (node_id!=params.bootstrap && (node_id+1)!=params.bootstrap);
+
+		if (do_defect && (no_bootstrap_link || !params.bootstrap_immunity) )
 		{
-#ifdef VERBOSE
-		    cout << "found link defect " << endl;
-#endif
-		    t[j][i]->r->disr.invalidate_direction(DIRECTION_EAST);
-		    t[j+1][i]->r->disr.invalidate_direction(DIRECTION_WEST);
-
-		    t[j][i]->r->reservation_table.invalidate(DIRECTION_EAST);
-		    t[j+1][i]->r->reservation_table.invalidate(DIRECTION_WEST);
+		    LOG(ctx, LOG_NET, LOG_INFO) << "found link defect " << node_id << " EAST";
+		    getNode(j, i)->r->disr.invalidate_direction(DIRECTION_EAST);
+		    getNode(j+1, i)->r->disr.invalidate_direction(DIRECTION_WEST);
+
+		    getNode(j, i)->r->reservation_table.invalidate(DIRECTION_EAST);
+		    getNode(j+1, i)->r->reservation_table.invalidate(DIRECTION_WEST);
 		}
 	    }
 	}
-	for (int i=0; i<GlobalParams::mesh_dim_y-1; i++)
+	for (int i=0; i<params.mesh_dim_y-1; i++)
 	{
-	    for (int j=0; j<GlobalParams::mesh_dim_x; j++)
+	    for (int j=0; j<params.mesh_dim_x; j++)
 	    {
-		int node_id = t[j][i]->r->local_id;
-#ifdef VERBOSE
-		cout << "\nAnalyzing vertical links, node " << node_id;
-#endif
-		do_defect = (((double) rand()) / RAND_MAX < GlobalParams::defective_links);
-		bool no_bootstrap_link = node_id!=GlobalParams::bootstrap && ((node_id+GlobalParams::mesh_dim_x)!=GlobalParams::bootstrap );
-
-		if (do_defect && (no_bootstrap_link || !GlobalParams::bootstrap_immunity) )
+		int node_id = getNode(j, i)->r->local_id;
+		double ran = ctx->rng.uniform(node_id, RANDOM_STREAM_LINK_SOUTH, 0);
+		LOG(ctx, LOG_NET, LOG_DEBUG) << "Analyzing vertical links, node " << node_id << " --> ran " << ran;
+		do_defect = (ran < params.defective_links);
+		bool no_bootstrap_link = node_id!=params.bootstrap && ((node_id+params.mesh_dim_x)!=params.bootstrap );
+
+		if (do_defect && (no_bootstrap_link || !params.bootstrap_immunity) )
 		{
-#ifdef VERBOSE
-		    cout << "found link defect " << endl;
-#endif
-		    t[j][i]->r->disr.invalidate_direction(DIRECTION_SOUTH);
-		    t[j][i+1]->r->disr.invalidate_direction(DIRECTION_NORTH);
-
-		    t[j][i]->r->reservation_table.invalidate(DIRECTION_SOUTH);
-		    t[j][i+1]->r->reservation_table.invalidate(DIRECTION_NORTH);
+		    LOG(ctx, LOG_NET, LOG_INFO) << "found link defect " << node_id << " SOUTH";
+		    getNode(j, i)->r->disr.invalidate_direction(DIRECTION_SOUTH);
+		    getNode(j, i+1)->r->disr.invalidate_direction(DIRECTION_NORTH);
+
+		    getNode(j, i)->r->reservation_table.invalidate(DIRECTION_SOUTH);
+		    getNode(j, i+1)->r->reservation_table.invalidate(DIRECTION_NORTH);
 		}
 	    }
 	}
@@ -275,13 +275,80 @@ void TNet::buildMesh()
 
 TNode* TNet::searchNode(const int id) const
 {
-  for (int i=0; i<GlobalParams::mesh_dim_x; i++)
-    for (int j=0; j<GlobalParams::mesh_dim_y; j++)
-      if (t[i][j]->r->local_id == id)
-	return t[i][j];
+  if (id < 0 || id >= (int)t.size())
+    return NULL;
+
+  return t[id];
+}
+
+//---------------------------------------------------------------------------
+
+bool TNet::isQuiescent() const
+{
+  for (unsigned int id=0; id<t.size(); id++)
+    if (!t[id]->r->isIdle() || !t[id]->pe->isIdle())
+      return false;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool TNet::isDiSRSettled() const
+{
+  for (unsigned int id=0; id<t.size(); id++)
+  {
+    DiSR_status status = t[id]->r->disr.getStatus();
+
+    if (status==BOOTSTRAP || status==ACTIVE_SEARCHING ||
+	status==CANDIDATE || status==CANDIDATE_STARTING)
+      return false;
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+int TNet::coveredNodes() const
+{
+  int covered = 0;
+
+  for (unsigned int id=0; id<t.size(); id++)
+    if (t[id]->r->disr.isAssigned())
+      covered++;
 
-  return false;
+  return covered;
 }
 
 //---------------------------------------------------------------------------
 
+void TNet::save(TCheckpoint& cp) const
+{
+    for (unsigned int id=0; id<t.size(); id++)
+    {
+	cp.put(t[id]->valid);
+	t[id]->r->save(cp);
+	t[id]->pe->save(cp);
+    }
+
+    for (unsigned int i=0; i<t.size() * LINKS_PER_NODE; i++)
+	links[i].save(cp);
+}
+
+//---------------------------------------------------------------------------
+
+void TNet::load(TCheckpoint& cp)
+{
+    for (unsigned int id=0; id<t.size(); id++)
+    {
+	cp.get(t[id]->valid);
+	t[id]->r->load(cp);
+	t[id]->pe->load(cp);
+    }
+
+    for (unsigned int i=0; i<t.size() * LINKS_PER_NODE; i++)
+	links[i].load(cp);
+}
+
+//---------------------------------------------------------------------------
@@ -9,7 +9,18 @@
 //---------------------------------------------------------------------------
 
 #include <systemc.h>
+#include <vector>
 #include "TNode.h"
+#include "TLink.h"
+
+using namespace std;
+
+class SimulationContext;
+
+// Channels of each node, see TNet::links
+#define LINKS_PER_NODE    (DIRECTIONS+2)
+#define LINK_TO_PE        (DIRECTIONS)
+#define LINK_FROM_PE      (DIRECTIONS+1)
 
 SC_MODULE(TNet)
 {
@@ -19,42 +30,71 @@ SC_MODULE(TNet)
   sc_in_clk        clock;        // The input clock for the Net
   sc_in<bool>      reset;        // The reset signal for the Net
 
-  // Signals
+  // Channels, LINKS_PER_NODE per node and each owned by the node it
+  // enters: entry linkIndex(id,d) carries what node id receives from
+  // direction d, followed by the router->PE and the PE->router local
+  // channels. Output channels towards the mesh boundary are looped back
+  // onto the (never driven) input of the same direction: those
+  // directions are invalidated in both the reservation table and DiSR,
+  // so they never toggle.
 
-  sc_signal<bool>    req_to_east[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<bool>    req_to_west[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<bool>    req_to_south[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<bool>    req_to_north[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
+  TLink*               links;
 
-  sc_signal<bool>    ack_to_east[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<bool>    ack_to_west[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<bool>    ack_to_south[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<bool>    ack_to_north[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
+  // The simulation this net belongs to
 
-  sc_signal<TPacket>   packet_to_east[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<TPacket>   packet_to_west[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<TPacket>   packet_to_south[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
-  sc_signal<TPacket>   packet_to_north[MAX_STATIC_DIM+1][MAX_STATIC_DIM+1];
+  SimulationContext*   ctx;
 
-  // Matrix of tiles
+  // Tiles, indexed by node id
 
-  TNode*             t[MAX_STATIC_DIM][MAX_STATIC_DIM];
+  vector<TNode*>       t;
 
   // Constructor
 
-  SC_CTOR(TNet)
+  TNet(sc_module_name name, SimulationContext* _ctx) : sc_module(name), ctx(_ctx)
   {
 
     // Build the Mesh
     buildMesh();
   }
 
+  ~TNet();
+
   // Support methods
   TNode* searchNode(const int id) const;
 
+  // Bring the mesh back to its just built state, with a new defect map
+  // drawn from ctx->rng (as reseeded for the run). Used between runs
+  void restart();
+
+  // True if no router or PE has anything left to do (nothing in flight)
+  bool isQuiescent() const;
+
+  // True if no node is still bootstrapping, searching or candidate
+  bool isDiSRSettled() const;
+
+  // Number of nodes assigned to a segment
+  int coveredNodes() const;
+
+  // Checkpoint of every node and channel, see TCheckpoint
+  void save(TCheckpoint& cp) const;
+  void load(TCheckpoint& cp);
+
+  inline TNode* getNode(const int x, const int y) const
+  {
+    return t[y * mesh_dim_x + x];
+  }
+
+  inline int linkIndex(const int id, const int direction) const
+  {
+    return id * LINKS_PER_NODE + direction;
+  }
+
 
  private:
   void buildMesh();
+  void applyDefects();            // Boundary and random (defective_*) invalid links
+
+  int mesh_dim_x;                 // ctx->params.mesh_dim_x, for getNode()
 };
 
 //---------------------------------------------------------------------------
@@ -4,35 +4,47 @@
 
  *****************************************************************************/
 #include "TProcessingElement.h"
+#include "SimulationContext.h"
+#include "TCheckpoint.h"
 
 //---------------------------------------------------------------------------
 
 int TProcessingElement::randInt(int min, int max)
 {
-  return min + (int)((double)(max-min+1) * rand()/(RAND_MAX+1.0));
+  return min + (int)((max-min+1) * ctx->rng.uniform(local_id, RANDOM_STREAM_TRAFFIC, random_draws++));
+}
+
+//---------------------------------------------------------------------------
+
+bool TProcessingElement::resetAsserted() const
+{
+  return native ? native_reset : reset.read();
 }
 
 //---------------------------------------------------------------------------
 
 void TProcessingElement::rxProcess()
 {
-  if(reset.read())
+  if(resetAsserted())
   {
-    ack_rx.write(0);
     current_level_rx = 0;
+    link_rx->writeAck(0);
   }
   else
   {
-    if(req_rx.read()==1-current_level_rx)
+    if(link_rx->req==1-current_level_rx)
     {
-      TPacket packet_tmp = packet_rx.read();
-      if(GlobalParams::verbose_mode > VERBOSE_OFF)
+      const TPacket& packet_tmp = link_rx->packet;
+      if (LOG_ENABLED(ctx, LOG_PE, LOG_INFO))
       {
-        cout << sc_simulation_time() << ": ProcessingElement[" << local_id << "] RECEIVING " << packet_tmp << endl;
+        TLogRecord record(ctx, LOG_PE);
+        record.stream() << "ProcessingElement[" << local_id << "] RECEIVING ";
+        if (ctx->params.verbose_mode == VERBOSE_HIGH)
+          record.stream() << packet_tmp;
       }
       current_level_rx = 1-current_level_rx;     // Negate the old value for Alternating Bit Protocol (ABP)
     }
-    ack_rx.write(current_level_rx);
+    link_rx->writeAck(current_level_rx);
   }
 }
 
@@ -40,10 +52,11 @@ void TProcessingElement::rxProcess()
 
 void TProcessingElement::txProcess()
 {
-    if(reset.read())
+    if(resetAsserted())
     {
-	req_tx.write(0);
 	current_level_tx = 0;
+	random_draws = 0;
+	link_tx->writeRequest(0);
     }
     else
     {
@@ -51,26 +64,28 @@ void TProcessingElement::txProcess()
 
 	if (canShot(packet))
 	{
-	    cout << "[PE "<< local_id<<"] can shot" << endl;
+	    LOG(ctx, LOG_PE, LOG_DEBUG) << "[PE "<< local_id<<"] can shot";
 	    packet_queue.push(packet);
 	}
 
 	//cout << "[PE "<< local_id<<"]:txProcess (checking if ack_tx == current_level)" << endl;
 	//cout << "[PE "<< local_id<<"] ack_tx " << ack_tx.read() << " current_level_tx " << current_level_tx << endl;
 
-	if(ack_tx.read() == current_level_tx)
+	if(link_tx->ack == current_level_tx)
 	{
 	    if(!packet_queue.empty())
 	    {
-		cout << "[PE " << local_id <<"] can send and has not emtpy queue" << endl;
+		LOG(ctx, LOG_PE, LOG_DEBUG) << "[PE " << local_id <<"] can send and has not emtpy queue";
 		TPacket packet = nextPacket();                  // Generate a new packet
-		if(GlobalParams::verbose_mode > VERBOSE_OFF)
+		if (LOG_ENABLED(ctx, LOG_PE, LOG_INFO))
 		{
-		    cout << sc_time_stamp().to_double()/1000 << ": ProcessingElement[" << local_id << "] SENDING " << packet << endl;
+		    TLogRecord record(ctx, LOG_PE);
+		    record.stream() << "ProcessingElement[" << local_id << "] SENDING ";
+		    if (ctx->params.verbose_mode == VERBOSE_HIGH)
+			record.stream() << packet;
 		}
-		packet_tx->write(packet);                     // Send the generated packet
 		current_level_tx = 1-current_level_tx;    // Negate the old value for Alternating Bit Protocol (ABP)
-		req_tx.write(current_level_tx);
+		link_tx->writeRequest(packet, current_level_tx);  // Send the generated packet
 	    }
 	}
     }
@@ -78,6 +93,53 @@ void TProcessingElement::txProcess()
 
 //---------------------------------------------------------------------------
 
+bool TProcessingElement::isIdle() const
+{
+  // Without DiSR the PE may generate traffic at any cycle
+  if (!ctx->params.disr)
+    return false;
+
+  return packet_queue.empty() && link_rx->req == current_level_rx;
+}
+
+//---------------------------------------------------------------------------
+
+void TProcessingElement::save(TCheckpoint& cp) const
+{
+  // The queue, oldest packet first
+  queue<TPacket> q = packet_queue;
+
+  cp.put(current_level_rx);
+  cp.put(current_level_tx);
+  cp.put(random_draws);
+  cp.put((uint32_t)q.size());
+  for (; !q.empty(); q.pop())
+    cp.put(q.front());
+}
+
+//---------------------------------------------------------------------------
+
+void TProcessingElement::load(TCheckpoint& cp)
+{
+  uint32_t n;
+
+  cp.get(current_level_rx);
+  cp.get(current_level_tx);
+  cp.get(random_draws);
+  cp.get(n);
+
+  packet_queue = queue<TPacket>();
+  for (uint32_t i = 0; i < n && cp.ok(); i++)
+  {
+    TPacket packet;
+
+    cp.get(packet);
+    packet_queue.push(packet);
+  }
+}
+
+//---------------------------------------------------------------------------
+
 TPacket TProcessingElement::nextPacket()
 {
   TPacket packet = packet_queue.front();
@@ -109,7 +171,7 @@ bool TProcessingElement::canShot(TPacket& packet)
     // TODO: add code here to choose PE behaviour
     int behaviour;
 
-    behaviour = GlobalParams::disr;
+    behaviour = ctx->params.disr;
     // DiSR, current testing approch:
     // - default is an XY routing where only node 0 sends packets
     // to a random destination
@@ -122,7 +184,7 @@ bool TProcessingElement::canShot(TPacket& packet)
     { 
 	case 0:
 
-	    if ( (local_id==0) && (((int)sc_time_stamp().to_double())%rate==0) )
+	    if ( (local_id==0) && (((int)(ctx->getCurrentCycle()*1000))%rate==0) )
 	    {
 		shot = true;
 		packet = trafficRandom();
@@ -149,7 +211,7 @@ TPacket TProcessingElement::trafficRandom()
 
   //cout << "\n " << sc_time_stamp().to_double()/1000 << " PE " << local_id << " rnd = " << rnd << endl;
 
-  int max_id = (GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y)-1;
+  int max_id = (ctx->params.mesh_dim_x * ctx->params.mesh_dim_y)-1;
 
   // Random destination distribution
   do
@@ -158,9 +220,9 @@ TPacket TProcessingElement::trafficRandom()
 
   } while(p.dst_id==p.src_id);
 
-  cout << "[PE "<<local_id<<"]: created packet with dst "<<p.dst_id << endl;
+  LOG(ctx, LOG_PE, LOG_DEBUG) << "[PE "<<local_id<<"]: created packet with dst "<<p.dst_id;
   
-  p.timestamp = sc_time_stamp().to_double()/1000;
+  p.timestamp = (int)ctx->getCurrentCycle();
 
   return p;
 }
@@ -181,8 +243,8 @@ void TProcessingElement::fixRanges(const TCoord src, TCoord& dst)
   // Fix ranges
   if(dst.x<0) dst.x=0;
   if(dst.y<0) dst.y=0;
-  if(dst.x>=GlobalParams::mesh_dim_x) dst.x=GlobalParams::mesh_dim_x-1;
-  if(dst.y>=GlobalParams::mesh_dim_y) dst.y=GlobalParams::mesh_dim_y-1;
+  if(dst.x>=ctx->params.mesh_dim_x) dst.x=ctx->params.mesh_dim_x-1;
+  if(dst.y>=ctx->params.mesh_dim_y) dst.y=ctx->params.mesh_dim_y-1;
 }
 
 //---------------------------------------------------------------------------
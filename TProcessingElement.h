@@ -11,8 +11,11 @@
 #include <queue>
 #include <systemc.h>
 #include "nanoxim.h"
+#include "TLink.h"
 using namespace std;
 
+class SimulationContext;
+
 SC_MODULE(TProcessingElement)
 {
 
@@ -21,13 +24,14 @@ SC_MODULE(TProcessingElement)
   sc_in_clk            clock;        // The input clock for the PE
   sc_in<bool>          reset;        // The reset signal for the PE
 
-  sc_in<TPacket>         packet_rx;      // The input channel
-  sc_in<bool>          req_rx;       // The request associated with the input channel
-  sc_out<bool>         ack_rx;       // The outgoing ack signal associated with the input channel
+  // Channels, bound by TNet::buildMesh()
+
+  TLink*               link_rx;                // The input channel
+  TLink*               link_tx;                // The output channel
 
-  sc_out<TPacket>        packet_tx;      // The output channel
-  sc_out<bool>         req_tx;       // The request associated with the output channel
-  sc_in<bool>          ack_tx;       // The outgoing ack signal associated with the output channel
+  // The simulation this PE belongs to
+
+  SimulationContext*   ctx;
 
   // Registers
 
@@ -35,6 +39,11 @@ SC_MODULE(TProcessingElement)
   bool                 current_level_rx;       // Current level for Alternating Bit Protocol (ABP)
   bool                 current_level_tx;       // Current level for Alternating Bit Protocol (ABP)
   queue<TPacket>       packet_queue;           // Local queue of packets
+  unsigned int         random_draws;           // Values taken so far from the RANDOM_STREAM_TRAFFIC stream
+
+  // Native engine bindings (unused when running under the SystemC kernel)
+  bool                 native;                 // True when driven by TNativeEngine
+  bool                 native_reset;           // Reset line as driven by TNativeEngine
 
   // Functions
 
@@ -43,6 +52,9 @@ SC_MODULE(TProcessingElement)
   bool                 canShot(TPacket& packet);          // True when the packet must be shot
   TPacket                nextPacket();                        // Take the next packet of the current packet
   TPacket              trafficRandom();                   // Random destination distribution
+  bool                 isIdle() const;                    // True if the PE has nothing to receive, send or generate
+  void                 save(TCheckpoint& cp) const;       // Registers and queue, see TCheckpoint
+  void                 load(TCheckpoint& cp);
 
   void                 fixRanges(const TCoord, TCoord&);  // Fix the ranges of the destination
   int                  randInt(int min, int max);         // Extracts a random integer number between min and max
@@ -51,9 +63,14 @@ SC_MODULE(TProcessingElement)
   int                  getBit(int x, int w);
   double               log2ceil(double x);
 
+  // Reset line, either the SystemC port or the native one
+  bool                 resetAsserted() const;
+
   // Constructor
 
-  SC_CTOR(TProcessingElement)
+  SC_HAS_PROCESS(TProcessingElement);
+
+  TProcessingElement(sc_module_name name, SimulationContext* _ctx) : sc_module(name), ctx(_ctx)
   {
     SC_METHOD(rxProcess);
     sensitive << reset;
@@ -62,6 +79,9 @@ SC_MODULE(TProcessingElement)
     SC_METHOD(txProcess);
     sensitive << reset;
     sensitive << clock.pos();
+
+    native = false;
+    random_draws = 0;
   }    
 
 };
@@ -0,0 +1,73 @@
+/*****************************************************************************
+
+  TRandom.h -- Per simulation pseudo-random number generator
+
+ *****************************************************************************/
+#ifndef __TRANDOM_H__
+#define __TRANDOM_H__
+
+//---------------------------------------------------------------------------
+
+#include <stdint.h>
+
+// Largest value returned by TRandom::get()
+#define RANDOM_MAX             2147483647
+
+// Random streams, each node draws from its own instance of every one
+#define RANDOM_STREAM_NODE_DEFECT    0   // Whether the node is defective
+#define RANDOM_STREAM_LINK_EAST      1   // Whether the link to the east neighbor is defective
+#define RANDOM_STREAM_LINK_SOUTH     2   // Whether the link to the south neighbor is defective
+#define RANDOM_STREAM_TRAFFIC        3   // Destinations picked by the PE
+
+//---------------------------------------------------------------------------
+// TRandom -- counter-based generator: a value is a hash of the (seed,
+// node, stream, draw) tuple, with no state carried from one draw to the
+// next. Any node's random decisions can thus be computed independently
+// and in any order, and don't depend on how the nodes are partitioned
+// among threads or on which node happens to be evaluated first.
+// The hash is a chain of SplitMix64 finalizers, one per key field.
+
+class TRandom
+{
+ public:
+
+  TRandom() { seed(1); }
+
+  void seed(unsigned int s)
+  {
+    key = mix(s);
+  }
+
+  // Returns the draw-th value of the stream of node, in 0..RANDOM_MAX
+  int get(const int node, const int stream, const unsigned int draw) const
+  {
+    uint64_t h = mix(key ^ (uint32_t)node);
+
+    h = mix(h ^ (uint32_t)stream);
+    h = mix(h ^ draw);
+
+    return (int)(h >> 33);
+  }
+
+  // Same as get(), scaled to [0,1)
+  double uniform(const int node, const int stream, const unsigned int draw) const
+  {
+    return get(node, stream, draw) / (RANDOM_MAX + 1.0);
+  }
+
+ private:
+
+  static uint64_t mix(uint64_t x)
+  {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  uint64_t key;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
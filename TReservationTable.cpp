@@ -10,6 +10,9 @@
 
 TReservationTable::TReservationTable()
 {
+  for (int i=0; i<DIRECTIONS+1; i++)
+    rtable[i] = NOT_RESERVED;
+
   clear();
 }
 
@@ -17,11 +20,12 @@ TReservationTable::TReservationTable()
 
 void TReservationTable::clear()
 {
-  rtable.resize(DIRECTIONS+1);
-  
   // note that NOT_VALID entries should remain untouched
   for (int i=0; i<DIRECTIONS+1; i++)
+  {
     if (rtable[i] != NOT_VALID) rtable[i] = NOT_RESERVED;
+    outputs[i] = 0;
+  }
 }
 
 //---------------------------------------------------------------------------
@@ -38,6 +42,19 @@ bool TReservationTable::isAvailable(const int port_out) const
 
 //---------------------------------------------------------------------------
 
+unsigned int TReservationTable::getAvailableMask() const
+{
+  unsigned int mask = 0;
+
+  for (int i=0; i<DIRECTIONS+1; i++)
+    if (rtable[i] == NOT_RESERVED)
+      mask |= DIRECTION_BIT(i);
+
+  return mask;
+}
+
+//---------------------------------------------------------------------------
+
 void TReservationTable::reserve(const int port_in, const int port_out)
 {
     // reservation of reserved/not valid ports is illegal. Correctness
@@ -45,31 +62,40 @@ void TReservationTable::reserve(const int port_in, const int port_out)
     assert(isAvailable(port_out));
 
     // check for previous reservation to be released
-  int port = getOutputPort(port_in);
-
-  if (port!=NOT_RESERVED)
-    release(port);
+  releaseInput(port_in);
 
   rtable[port_out] = port_in;
+  outputs[port_in] = DIRECTION_BIT(port_out);
 }
 //---------------------------------------------------------------------------
 
-void TReservationTable::reserve(const int port_in, const vector<int>& port_out)
+void TReservationTable::reserveMask(const int port_in, const unsigned int ports_out)
 {
     // reservation of reserved/not valid ports is illegal. Correctness
     // should be assured by TReservationTable users
-
-    for (unsigned int j=0;j<port_out.size();j++)
-	assert(isAvailable(port_out[j]));
+    assert((ports_out & ~getAvailableMask()) == 0);
 
     // check for previous reservation to be released
-  vector<int> ports = getMultiOutputPort(port_in);
+  releaseInput(port_in);
+
+  for (int i=0; i<DIRECTIONS+1; i++)
+      if (ports_out & DIRECTION_BIT(i))
+	  rtable[i] = port_in;
+
+  outputs[port_in] = ports_out;
+}
 
-  for (unsigned int j=0;j<ports.size();j++)
-      if (ports[j]!=NOT_RESERVED) release(ports[j]);
+//---------------------------------------------------------------------------
+
+void TReservationTable::releaseInput(const int port_in)
+{
+  assert(port_in >= 0 && port_in < DIRECTIONS+1);
 
-  for (unsigned int j=0;j<port_out.size();j++)
-      rtable[port_out[j]] = port_in;
+  for (int i=0; i<DIRECTIONS+1; i++)
+      if (outputs[port_in] & DIRECTION_BIT(i))
+	  rtable[i] = NOT_RESERVED;
+
+  outputs[port_in] = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -80,6 +106,7 @@ void TReservationTable::release(const int port_out)
     // there is a valid reservation on port_out
   assert(rtable[port_out] >= 0 && rtable[port_out] < DIRECTIONS+1);
 
+  outputs[rtable[port_out]] &= ~DIRECTION_BIT(port_out);
   rtable[port_out] = NOT_RESERVED;
 }
 
@@ -90,7 +117,7 @@ int TReservationTable::getOutputPort(const int port_in) const
   assert(port_in >= 0 && port_in < DIRECTIONS+1);
 
   for (int i=0; i<DIRECTIONS+1; i++)
-    if (rtable[i] == port_in)
+    if (outputs[port_in] & DIRECTION_BIT(i))
       return i; // port_in reserved outport i
 
   // semantic: port_in currently doesn't reserve any out port
@@ -98,25 +125,34 @@ int TReservationTable::getOutputPort(const int port_in) const
 }
 //---------------------------------------------------------------------------
 
-vector<int> TReservationTable::getMultiOutputPort(const int port_in) const
+unsigned int TReservationTable::getOutputMask(const int port_in) const
 {
-    vector<int> dirs;
   assert(port_in >= 0 && port_in < DIRECTIONS+1);
 
-  for (int i=0; i<DIRECTIONS+1; i++)
-    if (rtable[i] == port_in)
-       dirs.push_back(i);// port_in reserved outport i
-
-  return dirs;
-
+  return outputs[port_in];
 }
 //---------------------------------------------------------------------------
 
 // makes port_out no longer available for reservation/release
 void TReservationTable::invalidate(const int port_out)
 {
+    if (rtable[port_out] >= 0)
+	outputs[rtable[port_out]] &= ~DIRECTION_BIT(port_out);
+
     rtable[port_out] = NOT_VALID;
 }
+//---------------------------------------------------------------------------
 
+void TReservationTable::save(TCheckpoint& cp) const
+{
+  cp.put(rtable);
+  cp.put(outputs);
+}
 
+//---------------------------------------------------------------------------
 
+void TReservationTable::load(TCheckpoint& cp)
+{
+  cp.get(rtable);
+  cp.get(outputs);
+}
@@ -9,10 +9,15 @@
 //---------------------------------------------------------------------------
 
 #include <cassert>
+#include "nanoxim.h"
+#include "TCheckpoint.h"
 
 using namespace std;
 
 //---------------------------------------------------------------------------
+// TReservationTable -- for each output port the input port owning it,
+// and for each input port the bitmask (see DIRECTION_BIT) of the output
+// ports it owns, so that multicast reservations are plain bit operations
 
 class TReservationTable
 {
@@ -26,11 +31,15 @@ class TReservationTable
   // check if port_out is reservable
   bool isAvailable(const int port_out) const;
 
+  // Bitmask of the reservable output ports
+  unsigned int getAvailableMask() const;
+
   // Connects port_in with port_out. Asserts if port_out is reserved
   void reserve(const int port_in, const int port_out);
 
-  // Connects port_in with port_out. Asserts if port_out is reserved
-  void reserve(const int port_in, const vector<int>&);
+  // Connects port_in with all the ports in the bitmask ports_out.
+  // Asserts if any of them is reserved
+  void reserveMask(const int port_in, const unsigned int ports_out);
 
   // Releases port_out connection. 
   // Asserts if port_out is not reserved or not valid
@@ -38,15 +47,25 @@ class TReservationTable
 
   // Returns the output port connected to port_in.
   int getOutputPort(const int port_in) const;
-  vector<int> getMultiOutputPort(const int port_in) const;
+
+  // Returns the bitmask of the output ports connected to port_in
+  unsigned int getOutputMask(const int port_in) const;
 
   // Makes output port no longer available for reservation/release
   void invalidate(const int port_out);
 
+  // Checkpoint of the table, see TCheckpoint
+  void save(TCheckpoint& cp) const;
+  void load(TCheckpoint& cp);
+
 private:
   
-  vector<int> rtable; // reservation vector: rtable[i] gives the input
-		      // port whose output port 'i' is connected to
+  void releaseInput(const int port_in);
+
+  int rtable[DIRECTIONS+1]; // reservation vector: rtable[i] gives the input
+			    // port whose output port 'i' is connected to
+  unsigned int outputs[DIRECTIONS+1]; // outputs[i] gives the output ports
+				      // connected to input port 'i'
 };
 
 //---------------------------------------------------------------------------
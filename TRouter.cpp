@@ -5,17 +5,19 @@
 *****************************************************************************/
 #include "TRouter.h"
 #include "Stats.h"
+#include "SimulationContext.h"
+#include "TCheckpoint.h"
 
 //---------------------------------------------------------------------------
 
 void TRouter::rxProcess()
 {
-    if(reset.read())
+    if(resetAsserted())
     {
 	// Clear outputs and indexes of receiving protocol
 	for(int i=0; i<DIRECTIONS+1; i++)
 	{
-	    ack_rx[i].write(0);
+	    writeAckRx(i, 0);
 	    current_level_rx[i] = 0;
 	}
 	reservation_table.clear();
@@ -26,7 +28,7 @@ void TRouter::rxProcess()
 	// event of actually receiving a new packet. For example:
 	// - bootstrapping node for first segment request
 	// - TODO: updating timeouts
-	if (GlobalParams::disr) disr.update_status();
+	if (ctx->params.disr) disr.update_status();
 	//
 	// For each channel decide if a new packet can be accepted
 	//
@@ -39,14 +41,17 @@ void TRouter::rxProcess()
 	    // 1) there is an incoming request
 	    // 2) there is a free slot in the input buffer of direction i
 
-	    if ( (req_rx[i].read()==1-current_level_rx[i]) && !buffer[i].IsFull() )
+	    if ( (readReqRx(i)==1-current_level_rx[i]) && !buffer[i].IsFull() )
 	    {
 		//cout << "[node " << local_id <<"] rxProcess() can receive from dir " << i << " with non-empty buffer" << endl;
-		TPacket received_packet = packet_rx[i].read();
+		const TPacket& received_packet = readPacketRx(i);
 
-		if(GlobalParams::verbose_mode > VERBOSE_OFF)
+		if (LOG_ENABLED(ctx, LOG_ROUTER, LOG_INFO))
 		{
-		    cout << sc_time_stamp().to_double()/1000 << ": Router[" << local_id <<"], Input[" << i << "], Received packet: " << received_packet << endl;
+		    TLogRecord record(ctx, LOG_ROUTER);
+		    record.stream() << "Router[" << local_id <<"], Input[" << i << "], Received packet: ";
+		    if (ctx->params.verbose_mode == VERBOSE_HIGH)
+			record.stream() << received_packet;
 		}
 
 		// Store the incoming packet in the circular buffer
@@ -55,7 +60,7 @@ void TRouter::rxProcess()
 		// Negate the old value for Alternating Bit Protocol (ABP)
 		current_level_rx[i] = 1-current_level_rx[i];
 	    }
-	    ack_rx[i].write(current_level_rx[i]);
+	    writeAckRx(i, current_level_rx[i]);
 	}
     }
 }
@@ -64,16 +69,16 @@ void TRouter::rxProcess()
 
 void TRouter::txProcess()
 {
-  if (reset.read())
+  if (resetAsserted())
     {
       // Clear outputs and indexes of transmitting protocol
       for(int i=0; i<DIRECTIONS+1; i++)
 	{
-	  req_tx[i].write(0);
+	  writeReqTx(i, 0);
 	  current_level_tx[i] = 0;
 	}
 	// DiSR
-      if (GlobalParams::disr) this->disr.reset();
+      if (ctx->params.disr) this->disr.reset();
     }
   else
     {
@@ -97,33 +102,36 @@ void TRouter::txProcess()
 
 	    if ( !buffer[i].IsEmpty() )
 	    {
-		TPacket packet = buffer[i].Front();
+		// processed in place: DiSR only rewrites packets it is
+		// going to consume (confirm/cancel generation)
+		TPacket& packet = buffer[i].Front();
 		packet.dir_in = i;
 
+		// Traced as it is now, process() may rewrite it
+		TTraceRecord *event = NULL;
+		if (ctx->trace)
+		    event = ctx->trace->add(local_id, (int)ctx->getCurrentCycle(), packet);
+
 		process_out[i] = process(packet);
+
+		if (event)
+		    event->action = process_out[i];
 #ifdef VERBOSE
-		cout << "[node " << local_id <<"] txProcess (1st phase reservation) : buffer["<<i<<"] not empty @time " << sc_time_stamp().to_double()/1000 <<  endl;
-		cout << "[node " << local_id <<"] process_out["<<i<<"]  = " << process_out[i] << " @time " << sc_time_stamp().to_double()/1000 <<  endl;
+		LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id <<"] txProcess (1st phase reservation) : buffer["<<i<<"] not empty";
+		LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id <<"] process_out["<<i<<"]  = " << process_out[i];
 #endif
 
 		// broadcast required //////////////////////////
 		if (process_out[i] == ACTION_FLOOD)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_FLOOD [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
-		    vector<int> directions;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_FLOOD [id " << packet.id << "]";
 
 		    //  broadcast should not send to the following directions:
 		    // - DIRECTION_LOCAL (that is 4)
 		    // - the direction which the packet came from (that is i)
-		    for (int d=0;d<DIRECTIONS;d++)
-		    {
-			if ( (d!=i) && (reservation_table.isAvailable(d)) )
-			{
-			    //cout << "[node " << local_id << "]:txProcess (flooding) adding reservation  i="<<i<<",o="<<d<<endl;
-			    directions.push_back(d);
-			}
-		    }
-		    reservation_table.reserve(i, directions);
+		    unsigned int directions = reservation_table.getAvailableMask() & DIRECTIONS_MESH & ~DIRECTION_BIT(i);
+
+		    reservation_table.reserveMask(i, directions);
 
 		    // TODO: Update DiSR LED - here or in actual forwading ???
 		    this->disr.setLinks(TVISITED,directions,packet.id);
@@ -132,17 +140,17 @@ void TRouter::txProcess()
 		}
 		else if (process_out[i]==ACTION_SKIP)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_SKIP [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_SKIP [id " << packet.id << "]";
 		    //TODO: take some action in reservation phase ?
 		}
 		else if (process_out[i]==ACTION_DISCARD)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_DISCARD [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_DISCARD [id " << packet.id << "]";
 		    //TODO: take some action in reservation phase ?
 		}
 		else  if (process_out[i]==ACTION_END_CONFIRM)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_END_CONFIRM [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_END_CONFIRM [id " << packet.id << "]";
 		}
 
 		// not control mode, just reserve a direction
@@ -151,41 +159,41 @@ void TRouter::txProcess()
 		    if (reservation_table.isAvailable(process_out[i]) )
 			reservation_table.reserve(i, process_out[i]);
 		    else
-			cout << "[node " << local_id << "]:txProcess WARNING not available reservation i="<<i<<",o="<<process_out<<endl;
+			LOG(ctx, LOG_ROUTER, LOG_WARNING) << "[node " << local_id << "]:txProcess WARNING not available reservation i="<<i<<",o="<<process_out;
 			
 
 		}
 		else if (process_out[i]==ACTION_CONFIRM)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_CONFIRM [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_CONFIRM [id " << packet.id << "]";
 		  // a confirmation packet has been injected in the local buffer that will be processed on next cycle
 		  process_out[DIRECTION_LOCAL] = ACTION_SKIP;
                  
 		}
 		else if (process_out[i]==ACTION_CANCEL_REQUEST)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_CANCEL_REQUEST [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_CANCEL_REQUEST [id " << packet.id << "]";
 		  // Similar to confirmation packet, a cancel packet has been injected in the local buffer that will be processed on next cycle
 		  process_out[DIRECTION_LOCAL] = ACTION_SKIP;
 		}
 		else  if (process_out[i]==ACTION_END_CANCEL)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_END_CANCEL [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_END_CANCEL [id " << packet.id << "]";
 		}
 		else  if (process_out[i]==ACTION_RETRY_REQUEST)
 		{
-		  cout << "[node " << local_id << "]: process["<<i<<"] =  ACTION_RETRY_REQUEST [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "]: process["<<i<<"] =  ACTION_RETRY_REQUEST [id " << packet.id << "]";
 		  // a new packet has been injected in the local buffer that will be processed on next cycle
 		  process_out[DIRECTION_LOCAL] = ACTION_SKIP;
 		}
 		else if (process_out[i]==NOT_VALID)
 		{
-		  cout << "[node " << local_id << "]: WARNING, process["<<i<<"] =  NOT_VALID [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  cerr << "[node " << local_id << "]: WARNING, process["<<i<<"] =  NOT_VALID [id " << packet.id << "]" << endl;
 		    assert(false);
 		}
 		else 
 		{
-		  cout << "[node " << local_id << "]: CRITICAL, UNSUPPORTED process["<<i<<"] =  " << process_out[i] << " [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  cerr << "[node " << local_id << "]: CRITICAL, UNSUPPORTED process["<<i<<"] =  " << process_out[i] << " [id " << packet.id << "]" << endl;
 		    assert(false);
 		}
 	    }
@@ -193,9 +201,9 @@ void TRouter::txProcess()
       start_from_port++;
 
 #ifdef VERBOSE
-	      cout << "[node " << local_id <<"] DEBUG between 1st phase - forwarding: " << endl;
+	      LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id <<"] DEBUG between 1st phase - forwarding: ";
 	      for (int z=0;z<DIRECTIONS+1;z++) 
-		  cout << "\t DEBUG process_out["<<z<<"] is " << process_out[z] << endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "\t DEBUG process_out["<<z<<"] is " << process_out[z];
 #endif 
       // 2nd phase: Forwarding
       for(int i=0; i<DIRECTIONS+1; i++)
@@ -203,35 +211,38 @@ void TRouter::txProcess()
 	  if ( !buffer[i].IsEmpty() )
 	  {
 #ifdef VERBOSE
-	      cout << "[node " << local_id <<"] txProcess (forwarding): buffer["<<i<<"] not empty @time " << sc_time_stamp().to_double()/1000 <<  endl;
+	      LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id <<"] txProcess (forwarding): buffer["<<i<<"] not empty";
 #endif 
-	      TPacket packet = buffer[i].Front();
+	      const TPacket& packet = buffer[i].Front();
 
 	      ////////////////////////////////////////////////////////////
 	      if (process_out[i]==ACTION_FLOOD)
 	      {
-		  vector<int> directions = reservation_table.getMultiOutputPort(i);
+		  unsigned int directions = reservation_table.getOutputMask(i);
 
-		  // Note that even with ACTION_FLOOD set  directions could be an empty or single value vector, if no other channels were available at the moment 
+		  // Note that even with ACTION_FLOOD set  directions could be an empty or single direction mask, if no other channels were available at the moment 
 
-		  if (directions.size()>0)
+		  if (directions != 0)
 		  {
 		      // DEBUG
-		      cout << "[node " << local_id << "] FORWARDING from DIR " << i << " to multiple directions: ";
-		      for (unsigned int j=0;j<directions.size();j++)
-			  cout << directions[j] << ",";
-
-		      cout << endl;
+		      if (LOG_ENABLED(ctx, LOG_ROUTER, LOG_DEBUG))
+		      {
+			  TLogRecord record(ctx, LOG_ROUTER);
+			  record.stream() << "[node " << local_id << "] FORWARDING from DIR " << i << " to multiple directions: ";
+			  for (int o=0;o<DIRECTIONS+1;o++)
+			      if (directions & DIRECTION_BIT(o))
+				  record.stream() << o << ",";
+		      }
 
-		      for (unsigned int j=0;j<directions.size();j++)
+		      for (int o=0;o<DIRECTIONS+1;o++) // current out dir
 		      {
-			  int o = directions[j]; // current out dir
+			  if (!(directions & DIRECTION_BIT(o)))
+			      continue;
 
-			  if ( current_level_tx[o]== ack_tx[o].read() )
+			  if ( current_level_tx[o]== readAckTx(o) )
 			  {
-			      packet_tx[o].write(packet);
 			      current_level_tx[o] = 1 - current_level_tx[o];
-			      req_tx[o].write(current_level_tx[o]);
+			      writeTx(o, packet, current_level_tx[o]);
 
 			      // DEBUG
 			      //cout << "****DEBUG***** " << " node " << local_id << " is FORWARDING writing " << current_level_tx[o] << " on DIR " << o << endl;
@@ -259,7 +270,7 @@ void TRouter::txProcess()
 	      }
 	      else if (process_out[i] == ACTION_SKIP)
 	      {
-		  cout << "[node " << local_id << "] skipping processing from dir " << i << endl;
+		  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "] skipping processing from dir " << i;
 		  // skip packet processing to next cycle
 	      }
 	      else  if (process_out[i]==ACTION_CONFIRM)
@@ -281,7 +292,7 @@ void TRouter::txProcess()
 		  // just trash the packet 
 		  flush_buffer(i);
 		  /*
-		     cout << "[node " << local_id << "] thrashing confirmed request from dir " << i << endl;
+		     LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "] thrashing confirmed request from dir " << i;
 		   */
 	      }
 	      else if (process_out[i]==ACTION_CANCEL_REQUEST)
@@ -293,7 +304,7 @@ void TRouter::txProcess()
 		  // just trash the packet 
 		  flush_buffer(i);
 		  /*
-		     cout << "[node " << local_id << "] thrashing confirmed request from dir " << i << endl;
+		     LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "] thrashing confirmed request from dir " << i;
 		   */
 	      }
 	      else if (process_out[i]==NOT_VALID)
@@ -303,7 +314,7 @@ void TRouter::txProcess()
 		  // received packet on a given direction D in order to
 		  // inject a CONFIRM packet from the local direction towards D. The buffer[DIRECTION_LOCAL] is found not empty
 		  // but the associated process_out remains NOT_VALID
-		  cout << "[node " << local_id << "]: WARNING, process["<<i<<"] =  NOT_VALID [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  cerr << "[node " << local_id << "]: WARNING, process["<<i<<"] =  NOT_VALID [id " << packet.id << "]" << endl;
 		  assert(false);
 	      }
 		else  if (process_out[i]==ACTION_RETRY_REQUEST)
@@ -317,45 +328,44 @@ void TRouter::txProcess()
 		  int o = reservation_table.getOutputPort(i);
 		  if (o>=0)
 		  {
-		      cout << "[node " << local_id << "] FORWARDING FROM " << i << " TO " << o << endl;
+		      LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "] FORWARDING FROM " << i << " TO " << o;
 
-		      if ( current_level_tx[o] == ack_tx[o].read() )
+		      if ( current_level_tx[o] == readAckTx(o) )
 		      {
 #ifdef VERBOSE
-			  cout << "**DEBUG** " << "@node " << local_id << " @time " <<sc_time_stamp().to_double()/1000 << " ABP current_level_tx["<<o<<"]="<<current_level_tx[o] << ", ack:" << ack_tx[o].read() << " req: " << req_tx[o]<< endl;
+			  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "**DEBUG** " << "@node " << local_id << " ABP current_level_tx["<<o<<"]="<<current_level_tx[o] << ", ack:" << readAckTx(o) << " req: " << readReqTx(o);
 #endif
-			  packet_tx[o].write(packet);
 			  current_level_tx[o] = 1 - current_level_tx[o];
-			  req_tx[o].write(current_level_tx[o]);
+			  writeTx(o, packet, current_level_tx[o]);
 			  flush_buffer(i);
 
 			  // TODO: always release ?
 			  reservation_table.release(o);
 
 #ifdef VERBOSE
-			  cout << "**DEBUG** " << "@node " << local_id << " @time " <<sc_time_stamp().to_double()/1000 << " ABP current_level_tx["<<o<<"]="<<current_level_tx[o] << ", ack:" << ack_tx[o].read() << " req: " << req_tx[o]<< endl;
+			  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "**DEBUG** " << "@node " << local_id << " ABP current_level_tx["<<o<<"]="<<current_level_tx[o] << ", ack:" << readAckTx(o) << " req: " << readReqTx(o);
 #endif
 			  // Update stats
 		      }
 		      else
 		      {
-			  cout << "WARNING " << "@node " << local_id << " @time " <<sc_time_stamp().to_double()/1000 << "___ ABP not ready____ " << endl;
-			  cout << "@node " << local_id << " @time " <<sc_time_stamp().to_double()/1000 << " ABP current_level_tx["<<o<<"]="<<current_level_tx[o] << ", ack:" << ack_tx[o].read() << " req: " << req_tx[o]<< endl;
-			  cout << "@node " << local_id << " @time " <<sc_time_stamp().to_double()/1000 << " releasing table entry " << o << endl;
+			  LOG(ctx, LOG_ROUTER, LOG_WARNING) << "WARNING " << "@node " << local_id << "___ ABP not ready____ ";
+			  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "@node " << local_id << " ABP current_level_tx["<<o<<"]="<<current_level_tx[o] << ", ack:" << readAckTx(o) << " req: " << readReqTx(o);
+			  LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "@node " << local_id << " releasing table entry " << o;
 			  reservation_table.release(o);
 		      }
 
 		  }
 		  else
 		  {
-		      cout << "[node " << local_id << "] WARNING: no available reservation for input  " << i << endl;
+		      LOG(ctx, LOG_ROUTER, LOG_WARNING) << "[node " << local_id << "] WARNING: no available reservation for input  " << i;
 		  }
 
 		  ///////////////////////////////////////////////
 	      }
 	      else 
 	      {
-		  cout << "[node " << local_id << "]: CRITICAL, UNSUPPORTED process["<<i<<"] =  " << process_out[i] << " [id " << packet.id << "] @time " <<sc_time_stamp().to_double()/1000<<endl;
+		  cerr << "[node " << local_id << "]: CRITICAL, UNSUPPORTED process["<<i<<"] =  " << process_out[i] << " [id " << packet.id << "]" << endl;
 		  assert(false);
 	      }
 	  } // if buffer not empty
@@ -365,13 +375,13 @@ void TRouter::txProcess()
 
 //---------------------------------------------------------------------------
 
-vector<int> TRouter::routingFunction(const TPacket& p) 
+int TRouter::routingFunction(const TPacket& p) 
 {
-  TCoord position  = id2Coord(local_id);
+  TCoord position  = id2Coord(local_id, ctx->params);
   //TCoord src_coord = id2Coord(p.src_id);
-  TCoord dst_coord = id2Coord(p.dst_id);
+  TCoord dst_coord = id2Coord(p.dst_id, ctx->params);
 
-  switch (GlobalParams::routing_algorithm)
+  switch (ctx->params.routing_algorithm)
     {
     case ROUTING_XY:
       return routingXY(position, dst_coord);
@@ -382,7 +392,7 @@ vector<int> TRouter::routingFunction(const TPacket& p)
 
   assert(false);
   // something weird happened, you shouldn't be here
-  return (vector<int>)(0);
+  return NOT_VALID;
 }
 
 //---------------------------------------------------------------------------
@@ -392,7 +402,7 @@ int TRouter::process(TPacket& p)
 
     // DiSR setup traffic management
     // TODO: make it in a better way...
-    if (GlobalParams::disr)
+    if (ctx->params.disr)
     {
 	return this->disr.process(p);
     }
@@ -404,11 +414,8 @@ int TRouter::process(TPacket& p)
     if (p.dst_id == local_id)
 	return DIRECTION_LOCAL;
 
-    // ...leaved for future compatibility with adaptive routing
-    vector<int> candidate_channels = routingFunction(p);
-
     // TODO: check if ok for YX
-    return candidate_channels[0];
+    return routingFunction(p);
 }
 
 
@@ -418,17 +425,17 @@ void TRouter::inject_to_network(const TPacket& p)
 
     if (!buffer[DIRECTION_LOCAL].IsFull())
     {
-	cout << "["<<local_id<<"]:Injecting packet!!" << endl;
+	LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "["<<local_id<<"]:Injecting packet!!";
 	buffer[DIRECTION_LOCAL].Push(p);
     }
     else
-	cout << "["<<local_id<<"]:cant Inject packet (buffer full)" << endl;
+	LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "["<<local_id<<"]:cant Inject packet (buffer full)";
 }
 
 void TRouter::flush_buffer(int d)
 {
 #ifdef VERBOSE
-    cout << "[node " << local_id << "] flushing buffer direction " << d << endl;
+    LOG(ctx, LOG_ROUTER, LOG_DEBUG) << "[node " << local_id << "] flushing buffer direction " << d;
 #endif
     this->buffer[d].Pop();
 }
@@ -438,20 +445,42 @@ void TRouter::flush_buffer(int d)
 
 //---------------------------------------------------------------------------
 
-vector<int> TRouter::routingXY(const TCoord& current, const TCoord& destination)
+bool TRouter::isIdle() const
+{
+    return idleCycles() == INT_MAX;
+}
+
+//---------------------------------------------------------------------------
+
+int TRouter::idleCycles() const
+{
+    for (int i=0; i<DIRECTIONS+1; i++)
+    {
+	if (!buffer[i].IsEmpty())
+	    return 0;
+
+	if (readReqRx(i) != current_level_rx[i])
+	    return 0;
+    }
+
+    if (!ctx->params.disr)
+	return INT_MAX;
+
+    return disr.idleCycles();
+}
+
+//---------------------------------------------------------------------------
+
+int TRouter::routingXY(const TCoord& current, const TCoord& destination)
 {
-  vector<int> directions;
-  
   if (destination.x > current.x)
-    directions.push_back(DIRECTION_EAST);
+    return DIRECTION_EAST;
   else if (destination.x < current.x)
-    directions.push_back(DIRECTION_WEST);
+    return DIRECTION_WEST;
   else if (destination.y > current.y)
-    directions.push_back(DIRECTION_SOUTH);
+    return DIRECTION_SOUTH;
   else
-    directions.push_back(DIRECTION_NORTH);
-
-  return directions;
+    return DIRECTION_NORTH;
 }
 
 //---------------------------------------------------------------------------
@@ -469,6 +498,49 @@ void TRouter::configure(const int _id, const unsigned int _max_buffer_size)
 
 //---------------------------------------------------------------------------
 
+void TRouter::restart()
+{
+  start_from_port = DIRECTION_LOCAL;
+
+  for (int i=0; i<DIRECTIONS+1; i++)
+    buffer[i].SetMaxBufferSize(buffer[i].GetMaxBufferSize());
+
+  reservation_table = TReservationTable();
+  disr.restore();
+}
+
+//---------------------------------------------------------------------------
+
+void TRouter::save(TCheckpoint& cp) const
+{
+  for (int i=0; i<DIRECTIONS+1; i++)
+    buffer[i].save(cp);
+
+  cp.put(current_level_rx);
+  cp.put(current_level_tx);
+  reservation_table.save(cp);
+  disr.save(cp);
+  cp.put(start_from_port);
+  stats.save(cp);
+}
+
+//---------------------------------------------------------------------------
+
+void TRouter::load(TCheckpoint& cp)
+{
+  for (int i=0; i<DIRECTIONS+1; i++)
+    buffer[i].load(cp);
+
+  cp.get(current_level_rx);
+  cp.get(current_level_tx);
+  reservation_table.load(cp);
+  disr.load(cp);
+  cp.get(start_from_port);
+  stats.load(cp);
+}
+
+//---------------------------------------------------------------------------
+
 int TRouter::reflexDirection(int direction) const
 {
     if (direction == DIRECTION_NORTH) return DIRECTION_SOUTH;
@@ -485,7 +557,7 @@ int TRouter::reflexDirection(int direction) const
 
 int TRouter::getNeighborId(int _id, int direction) const
 {
-    TCoord my_coord = id2Coord(_id);
+    TCoord my_coord = id2Coord(_id, ctx->params);
 
     switch (direction)
     {
@@ -494,11 +566,11 @@ int TRouter::getNeighborId(int _id, int direction) const
 	    my_coord.y--;
 	    break;
 	case DIRECTION_SOUTH:
-	    if (my_coord.y==GlobalParams::mesh_dim_y-1) return NOT_VALID;
+	    if (my_coord.y==ctx->params.mesh_dim_y-1) return NOT_VALID;
 	    my_coord.y++;
 	    break;
 	case DIRECTION_EAST:
-	    if (my_coord.x==GlobalParams::mesh_dim_x-1) return NOT_VALID;
+	    if (my_coord.x==ctx->params.mesh_dim_x-1) return NOT_VALID;
 	    my_coord.x++;
 	    break;
 	case DIRECTION_WEST:
@@ -506,11 +578,11 @@ int TRouter::getNeighborId(int _id, int direction) const
 	    my_coord.x--;
 	    break;
 	default:
-	    cout << "direction not valid : " << direction;
+	    cerr << "direction not valid : " << direction << endl;
 	    assert(false);
     }
 
-    int neighbor_id = coord2Id(my_coord);
+    int neighbor_id = coord2Id(my_coord, ctx->params);
 
   return neighbor_id;
 }
@@ -519,3 +591,11 @@ int TRouter::getNeighborId(int _id, int direction) const
 
 
 //---------------------------------------------------------------------------
+
+bool TRouter::resetAsserted() const
+{
+    return native ? native_reset : reset.read();
+}
+
+//---------------------------------------------------------------------------
+
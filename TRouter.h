@@ -13,7 +13,9 @@
 #include "TBuffer.h"
 #include "TReservationTable.h"
 #include "Stats.h"
+#include "TLink.h"
 
+class SimulationContext;
 
 SC_MODULE(TRouter)
 {
@@ -23,13 +25,14 @@ SC_MODULE(TRouter)
   sc_in_clk          clock;        // The input clock for the router
   sc_in<bool>        reset;        // The reset signal for the router
 
-  sc_in<TPacket>       packet_rx[DIRECTIONS+1];   // The input channels (including local one)
-  sc_in<bool>        req_rx[DIRECTIONS+1];    // The requests associated with the input channels
-  sc_out<bool>       ack_rx[DIRECTIONS+1];    // The outgoing ack signals associated with the input channels
+  // Channels, bound by TNet::buildMesh()
 
-  sc_out<TPacket>      packet_tx[DIRECTIONS+1];   // The output channels (including local one)
-  sc_out<bool>       req_tx[DIRECTIONS+1];    // The requests associated with the output channels
-  sc_in<bool>        ack_tx[DIRECTIONS+1];    // The outgoing ack signals associated with the output channels
+  TLink*             link_rx[DIRECTIONS+1];           // The input channels (including local one)
+  TLink*             link_tx[DIRECTIONS+1];           // The output channels (including local one)
+
+  // The simulation this router belongs to
+
+  SimulationContext* ctx;
 
   // Registers
 
@@ -45,17 +48,29 @@ SC_MODULE(TRouter)
   DiSR disr;						// DiSR component implementing algorithm locally
   int                start_from_port;                 // Port from which to start the reservation cycle
   Stats stats;
+
+  // Native engine bindings (unused when running under the SystemC kernel)
+  bool               native;                          // True when driven by TNativeEngine
+  bool               native_reset;                    // Reset line as driven by TNativeEngine
+
   // Functions
 
   void               rxProcess();        // The receiving process
   void               txProcess();        // The transmitting process
   void               configure(const int _id, const unsigned int _max_buffer_size);
+  void               restart();          // Back to the configure() state, before a new run
   void inject_to_network(const TPacket& p);
   void flush_buffer(int);
+  bool isIdle() const;        // True if evaluating the router would only advance start_from_port
+  int idleCycles() const;     // Upcoming cycles in which it would only count down DiSR timers
+  void save(TCheckpoint& cp) const;   // Registers, buffers, DiSR and stats, see TCheckpoint
+  void load(TCheckpoint& cp);
 
   // Constructor
 
-  SC_CTOR(TRouter)
+  SC_HAS_PROCESS(TRouter);
+
+  TRouter(sc_module_name name, SimulationContext* _ctx) : sc_module(name), ctx(_ctx)
   {
     SC_METHOD(rxProcess);
     sensitive << reset;
@@ -64,6 +79,8 @@ SC_MODULE(TRouter)
     SC_METHOD(txProcess);
     sensitive << reset;
     sensitive << clock.pos();
+
+    native = false;
   }
 
   int getNeighborId(int _id,int direction) const;
@@ -71,14 +88,25 @@ SC_MODULE(TRouter)
  private:
   // performs actual routing + selection
   int process(TPacket& p);
-  vector<int> routingFunction(const TPacket& p);
+  int routingFunction(const TPacket& p);
 
 
 
   // routing functions
-  vector<int> routingXY(const TCoord& current, const TCoord& destination);
+  int routingXY(const TCoord& current, const TCoord& destination);
   int reflexDirection(int direction) const;
 
+  bool resetAsserted() const;
+
+  // channel access
+  inline bool readReqRx(const int i) const { return link_rx[i]->req; }
+  inline const TPacket& readPacketRx(const int i) const { return link_rx[i]->packet; }
+  inline void writeAckRx(const int i, const bool level) { link_rx[i]->writeAck(level); }
+  inline bool readAckTx(const int o) const { return link_tx[o]->ack; }
+  inline bool readReqTx(const int o) const { return link_tx[o]->req; }
+  inline void writeTx(const int o, const TPacket& p, const bool level) { link_tx[o]->writeRequest(p, level); }
+  inline void writeReqTx(const int o, const bool level) { link_tx[o]->writeRequest(level); }
+
 
 
 };
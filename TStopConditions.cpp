@@ -0,0 +1,89 @@
+/*****************************************************************************
+
+  TStopConditions.cpp -- Conditions for ending a simulation early
+
+ *****************************************************************************/
+#include "TStopConditions.h"
+#include "SimulationContext.h"
+
+//---------------------------------------------------------------------------
+
+TStopConditions::TStopConditions(const TNet * _net)
+{
+    net = _net;
+    start();
+}
+
+//---------------------------------------------------------------------------
+
+bool TStopConditions::enabled() const
+{
+    const SimulationParams& params = net->ctx->params;
+
+    return params.stop_converged || params.stop_coverage > 0 ||
+	params.max_wallclock > 0;
+}
+
+//---------------------------------------------------------------------------
+
+void TStopConditions::start()
+{
+    gettimeofday(&start_time, NULL);
+}
+
+//---------------------------------------------------------------------------
+
+double TStopConditions::elapsed() const
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (now.tv_sec - start_time.tv_sec) + (now.tv_usec - start_time.tv_usec) / 1e6;
+}
+
+//---------------------------------------------------------------------------
+
+int TStopConditions::check(const bool quiescent, const int covered_nodes) const
+{
+    const SimulationParams& params = net->ctx->params;
+
+    // Nothing can change anymore. DiSR may still have nodes waiting for
+    // an answer that will never come: that is a stall, not a convergence
+    if (params.stop_converged && quiescent)
+	return net->isDiSRSettled() ? STOP_CONVERGED : STOP_STALLED;
+
+    if (params.stop_coverage > 0 &&
+	covered_nodes >= params.stop_coverage * net->t.size())
+	return STOP_NODE_COVERAGE;
+
+    if (params.max_wallclock > 0 && elapsed() >= params.max_wallclock)
+	return STOP_WALLCLOCK;
+
+    return STOP_NONE;
+}
+
+//---------------------------------------------------------------------------
+
+const char* TStopConditions::describe(const int reason)
+{
+    switch (reason)
+    {
+	case STOP_SIMULATION_TIME:
+	    return "simulation time";
+	case STOP_CONVERGED:
+	    return "converged";
+	case STOP_NODE_COVERAGE:
+	    return "node coverage";
+	case STOP_WALLCLOCK:
+	    return "wall-clock budget";
+	case STOP_STALLED:
+	    return "stalled";
+	default:
+	    assert(false);
+    }
+
+    return NULL;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,49 @@
+/*****************************************************************************
+
+  TStopConditions.h -- Conditions for ending a simulation early
+
+ *****************************************************************************/
+#ifndef __TSTOPCONDITIONS_H__
+#define __TSTOPCONDITIONS_H__
+
+//---------------------------------------------------------------------------
+
+#include <sys/time.h>
+#include "TNet.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// TStopConditions -- checks, at the end of a cycle, whether the run can
+// stop before SimulationParams::simulation_time. The engines pass in the
+// quiescence and coverage they observed, so that the native engine can
+// keep them up to date incrementally instead of scanning the mesh.
+
+class TStopConditions
+{
+ public:
+
+  TStopConditions(const TNet * _net);
+
+  // True if any early stop condition has been requested
+  bool enabled() const;
+
+  // Start the wall-clock budget
+  void start();
+
+  // Returns the condition holding now, or STOP_NONE
+  int check(const bool quiescent, const int covered_nodes) const;
+
+  static const char* describe(const int reason);
+
+ private:
+
+  double elapsed() const;
+
+  const TNet *net;
+  struct timeval start_time;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,111 @@
+/*****************************************************************************
+
+  TTrace.cpp -- Binary packet event trace implementation
+
+ *****************************************************************************/
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include "TTrace.h"
+
+//---------------------------------------------------------------------------
+
+TTrace::TTrace(const int _nodes)
+{
+  fd = -1;
+  nodes = _nodes;
+  run = 0;
+  records.resize(nodes * TRACE_BLOCK_RECORDS);
+  used.resize(nodes, 0);
+  pthread_mutex_init(&mutex, NULL);
+}
+
+//---------------------------------------------------------------------------
+
+TTrace::~TTrace()
+{
+  flush();
+
+  if (fd >= 0)
+    close(fd);
+
+  pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------------------------------------------------
+
+static bool writeAll(const int fd, const void *data, size_t size)
+{
+  const char *p = (const char *)data;
+
+  while (size > 0)
+  {
+    ssize_t written = write(fd, p, size);
+
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+
+    p += written;
+    size -= written;
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool TTrace::open(const string& fname, const int dim_x, const int dim_y)
+{
+  fd = ::open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0)
+    return false;
+
+  TTraceHeader header;
+
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+  header.version = TRACE_VERSION;
+  header.record_size = sizeof(TTraceRecord);
+  header.mesh_dim_x = dim_x;
+  header.mesh_dim_y = dim_y;
+
+  return writeAll(fd, &header, sizeof(header));
+}
+
+//---------------------------------------------------------------------------
+
+void TTrace::writeBlock(const int node)
+{
+  pthread_mutex_lock(&mutex);
+  bool ok = writeAll(fd, &records[node * TRACE_BLOCK_RECORDS], used[node] * sizeof(TTraceRecord));
+  pthread_mutex_unlock(&mutex);
+
+  assert(ok);
+  used[node] = 0;
+}
+
+//---------------------------------------------------------------------------
+
+void TTrace::flush()
+{
+  if (fd < 0)
+    return;
+
+  for (int node = 0; node < nodes; node++)
+    if (used[node] > 0)
+      writeBlock(node);
+}
+
+//---------------------------------------------------------------------------
+
+void TTrace::setRun(const int _run)
+{
+  flush();
+  run = _run;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,81 @@
+/*****************************************************************************
+
+  TTrace.h -- Binary packet event trace
+
+ *****************************************************************************/
+#ifndef __TTRACE_H__
+#define __TTRACE_H__
+
+//---------------------------------------------------------------------------
+
+#include <vector>
+#include <string>
+#include <pthread.h>
+#include "nanoxim.h"
+#include "TTraceFormat.h"
+
+using namespace std;
+
+// Records buffered for each node before they are written out as a block
+#define TRACE_BLOCK_RECORDS    256
+
+//---------------------------------------------------------------------------
+// TTrace -- writes a TTraceRecord for every action of the routers, see
+// TTraceFormat.h and tools/nanoxim_trace. Each node fills a preallocated
+// block of its own, so the threads of the native engine (a node is
+// always evaluated by the same one) never contend for it; a full block
+// goes to the file with a single write().
+
+class TTrace
+{
+ public:
+
+  TTrace(const int _nodes);
+  ~TTrace();
+
+  // Create the trace file, false on failure
+  bool open(const string& fname, const int dim_x, const int dim_y);
+
+  // Record for the packet at the head of an input buffer of node; the
+  // caller fills in the action once decided
+  TTraceRecord* add(const int node, const int cycle, const TPacket& packet)
+  {
+    if (used[node] == TRACE_BLOCK_RECORDS)
+      writeBlock(node);
+
+    TTraceRecord *r = &records[node * TRACE_BLOCK_RECORDS + used[node]++];
+
+    r->cycle = cycle;
+    r->node = node;
+    r->segment_node = packet.id.getNode();
+    r->segment_link = packet.id.getLink();
+    r->action = NOT_VALID;
+    r->dir_in = packet.dir_in;
+    r->type = packet.type;
+    r->run = run;
+    r->unused = 0;
+
+    return r;
+  }
+
+  // Write out every pending record
+  void flush();
+
+  // Tag the next records with the index of a new run
+  void setRun(const int _run);
+
+ private:
+
+  void writeBlock(const int node);
+
+  int fd;
+  int nodes;
+  uint16_t run;
+  vector<TTraceRecord> records;     // TRACE_BLOCK_RECORDS for each node
+  vector<int> used;                 // Records pending in each block
+  pthread_mutex_t mutex;            // Serializes the writes of the blocks
+};
+
+//---------------------------------------------------------------------------
+
+#endif
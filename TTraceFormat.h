@@ -0,0 +1,47 @@
+/*****************************************************************************
+
+  TTraceFormat.h -- Layout of the packet event trace files
+
+ *****************************************************************************/
+#ifndef __TTRACEFORMAT_H__
+#define __TTRACEFORMAT_H__
+
+//---------------------------------------------------------------------------
+// A trace (-trace FILE) is a TTraceHeader followed by TTraceRecord's, in
+// the byte order of the machine that wrote it. Records come in blocks,
+// each one holding consecutive events of a single node: the events of a
+// node are in order, those of different nodes are not. This header
+// stays free of SystemC, so the offline tools can include it alone.
+
+#include <stdint.h>
+
+#define TRACE_MAGIC            "NXTRACE"
+#define TRACE_VERSION          1
+
+struct TTraceHeader
+{
+  char     magic[8];           // TRACE_MAGIC, zero padded
+  int32_t  version;            // TRACE_VERSION
+  int32_t  record_size;        // sizeof(TTraceRecord)
+  int32_t  mesh_dim_x;
+  int32_t  mesh_dim_y;
+};
+
+// One router action: the packet at the head of an input buffer, as it
+// was before TRouter::process(), and what process() decided for it
+struct TTraceRecord
+{
+  int32_t  cycle;
+  int32_t  node;
+  int32_t  segment_node;       // TSegmentId of the packet
+  int32_t  segment_link;
+  int16_t  action;             // ACTION_*, an output direction or NOT_VALID
+  int8_t   dir_in;             // DIRECTION_*
+  uint8_t  type;               // TPacketType
+  uint16_t run;                // Run of the batch, see SimulationContext::run
+  uint16_t unused;
+};
+
+//---------------------------------------------------------------------------
+
+#endif
@@ -23,73 +23,90 @@
 
 #include <systemc.h>
 #include "nanoxim.h"
-#include "TNet.h"
+#include "SimulationContext.h"
+#include "TStopConditions.h"
 #include "CmdLineParser.h"
-#include "GlobalStats.h"
+#include "ForkServer.h"
 
 using namespace std;
 
 //---------------------------------------------------------------------------
 
-// Initialize global configuration parameters (can be overridden with command-line arguments)
-int   GlobalParams::mesh_dim_x                       = DEFAULT_MESH_DIM_X;
-int   GlobalParams::mesh_dim_y                       = DEFAULT_MESH_DIM_Y;
-int   GlobalParams::buffer_depth                     = DEFAULT_BUFFER_DEPTH;
-int   GlobalParams::routing_algorithm                = ROUTING_XY;
-int   GlobalParams::verbose_mode		      = DEFAULT_VERBOSE_MODE;
-int   GlobalParams::simulation_time		      = DEFAULT_SIMULATION_TIME;
-int   GlobalParams::rnd_generator_seed               = (time(NULL)+getpid());
-int   GlobalParams::disr               		= DEFAULT_DISR_SETUP;
-int   GlobalParams::bootstrap               	= DEFAULT_DISR_BOOTSTRAP_NODE;
-int   GlobalParams::ttl               = DEFAULT_MESH_DIM_X;
-int   GlobalParams::bootstrap_timeout               = DEFAULT_BOOTSTRAP_TIMEOUT;
-int   GlobalParams::bootstrap_immunity               = DEFAULT_BOOTSTRAP_IMMUNITY;
-int   GlobalParams::graphviz               = DEFAULT_GRAPHVIZ;
-int   GlobalParams::cyclelinks               	     = DEFAULT_CYCLE_LINKS;
-double   GlobalParams::defective_links		     = 0;
-double   GlobalParams::defective_nodes		     = 0;
-
-//---------------------------------------------------------------------------
-
 int sc_main(int arg_num, char* arg_vet[])
 {
   // Handle command-line arguments
   cout << endl << "\t\tNanoxim - nanonetwork simulator" << endl;
   cout << "\t\t(C) University of Catania" << endl << endl;
 
-  parseCmdLine(arg_num, arg_vet);
-
-  cout << "\n Using seed " << GlobalParams::rnd_generator_seed << endl;
-  srand(GlobalParams::rnd_generator_seed); // time(NULL));
-  // Signals
-  // TODO: check for nanorealistic frequencies
-  sc_clock        clock("clock", 1, SC_NS);
-  sc_signal<bool> reset;
-
-  // network instance
-  TNet* n = new TNet("Net");
-  n->clock(clock);
-  n->reset(reset);
-
-  // Reset the chip and run the simulation
-  reset.write(1);
-  cout << "Reset...";
-  sc_start(DEFAULT_RESET_TIME, SC_NS);
-  reset.write(0);
-  cout << " done! Now running for " << GlobalParams::simulation_time << " cycles..." << endl;
-  sc_start(GlobalParams::simulation_time, SC_NS);
-
-  // Close the simulation
-  cout << "network simulation completed." << endl;
-  cout << " ( " << sc_time_stamp().to_double()/1000 << " cycles executed)" << endl;
-
-  // Show statistics
-  GlobalStats gs(n);
-  if (GlobalParams::graphviz)
-      gs.drawGraphviz();
-  gs.writeStats();
+  SimulationParams params;
+
+  parseCmdLine(arg_num, arg_vet, params);
+
+  // The mesh, its defects and the seed are the checkpoint ones
+  if (!params.restore_file.empty() && !SimulationContext::loadCheckpointParams(params.restore_file, params))
+  {
+      cerr << "Error: " << params.restore_file << " is not a valid checkpoint" << endl;
+      exit(1);
+  }
+
+  if (!params.log_file.empty() && !TLog::open(params.log_file))
+  {
+      cerr << "Error: cannot open the log file " << params.log_file << endl;
+      exit(1);
+  }
+
+  // One seed per run, consecutive ones unless listed with -seed_list
+  vector<int> seeds = params.seed_list;
+  for (int r = seeds.size(); r < params.runs; r++)
+      seeds.push_back(params.rnd_generator_seed + r);
+
+  params.rnd_generator_seed = seeds[0];
+  cout << "\n Using seed " << params.rnd_generator_seed << endl;
+
+  // network instance, elaborated once for all the runs
+  SimulationContext ctx(params);
+  ctx.build();
+
+  if (!params.restore_file.empty() && !ctx.loadCheckpoint(params.restore_file))
+  {
+      cerr << "Error: cannot restore " << params.restore_file << endl;
+      exit(1);
+  }
+
+  // The network just built is shared by all the requests
+  if (!params.fork_server_file.empty())
+  {
+      ForkServer server(ctx, arg_num, arg_vet);
+
+      if (!server.serve(params.fork_server_file))
+      {
+	  cerr << "Error: cannot open the control file " << params.fork_server_file << endl;
+	  exit(1);
+      }
+      return 0;
+  }
+
+  for (unsigned int run = 0; run < seeds.size(); run++)
+  {
+      if (run > 0)
+      {
+	  cout << "\n Run " << run+1 << " of " << seeds.size() << ", using seed " << seeds[run] << endl;
+	  ctx.restart(seeds[run]);
+      }
+
+      int stop_reason = ctx.simulate();
+
+      // Close the simulation
+      cout << "network simulation completed (stop condition: " << TStopConditions::describe(stop_reason) << ")." << endl;
+      cout << " ( " << ctx.getCurrentCycle() << " cycles executed)" << endl;
+
+      // Show statistics, one results file per run
+      ctx.writeResults(stop_reason);
+  }
 
   return 0;
 
 }
 
+
+//---------------------------------------------------------------------------
@@ -6,6 +6,9 @@
 #include <cassert>
 #include <systemc.h>
 #include <vector>
+#include <string>
+#include <climits>
+#include <stdint.h>
 
 using namespace std;
 
@@ -19,6 +22,10 @@ using namespace std;
 #define DIRECTION_WEST         3
 #define DIRECTION_LOCAL        4
 
+// Sets of directions are bitmasks of DIRECTION_BIT(d)
+#define DIRECTION_BIT(d)       (1u << (d))
+#define DIRECTIONS_MESH        ((1u << DIRECTIONS) - 1)
+
 
 // ACTIONS
 // flood all available out directions, ignore packet, confirm requests
@@ -43,6 +50,18 @@ using namespace std;
 // Routing algorithms
 #define ROUTING_XY             0
 
+// Simulation engines
+#define ENGINE_SYSTEMC         0
+#define ENGINE_NATIVE          1
+
+// Reasons for ending a simulation
+#define STOP_NONE             -1
+#define STOP_SIMULATION_TIME   0
+#define STOP_CONVERGED         1
+#define STOP_NODE_COVERAGE     2
+#define STOP_WALLCLOCK         3
+#define STOP_STALLED           4
+
 // type of link to be set
 #define VISITED 1
 #define TVISITED 2
@@ -74,9 +93,14 @@ using namespace std;
 #define DEFAULT_CYCLE_LINKS			1
 #define DEFAULT_DEFECTIVE_LINKS			0
 #define DEFAULT_GRAPHVIZ			0
-
-// TODO by Fafa - this MUST be removed!!!
-#define MAX_STATIC_DIM 30
+#define DEFAULT_ENGINE			ENGINE_SYSTEMC
+#define DEFAULT_THREADS				1
+#define DEFAULT_STOP_CONVERGED			0
+#define DEFAULT_STOP_COVERAGE			0
+#define DEFAULT_MAX_WALLCLOCK			0
+#define DEFAULT_RUNS				1
+#define DEFAULT_FORK_JOBS			1
+#define DEFAULT_LOG_CATEGORIES		0x1f    // All of them, see TLog.h
 
 enum DiSR_status { BOOTSTRAP, 
 		   ACTIVE_SEARCHING, 
@@ -87,25 +111,65 @@ enum DiSR_status { BOOTSTRAP,
 };
 
 //---------------------------------------------------------------------------
-// GlobalParams -- used to forward configuration to every sub-block
-struct GlobalParams
+// SimulationParams -- configuration of a simulation, owned by its
+// SimulationContext and forwarded from there to every sub-block
+struct SimulationParams
+{
+  int verbose_mode;
+  int mesh_dim_x;
+  int mesh_dim_y;
+  int buffer_depth;
+  int routing_algorithm;
+  int simulation_time;
+  int rnd_generator_seed;
+  int disr;
+  int bootstrap;
+  int bootstrap_timeout;
+  int ttl;
+  int bootstrap_immunity;
+  int cyclelinks;
+  int graphviz;
+  int engine;
+  int threads;
+  int stop_converged;
+  double stop_coverage;
+  double max_wallclock;
+  double defective_links;
+  double defective_nodes;
+  int runs;
+  vector<int> seed_list;
+  string output_file;         // Results file, empty for the default name
+  int log_categories;         // Categories logged at the verbose_mode level, see TLog.h
+  string log_file;            // Log file, empty for the standard output
+  string trace_file;          // Binary packet event trace, empty for none
+  int checkpoint_cycle;       // Cycle at which to save a checkpoint, 0 for none
+  string checkpoint_file;
+  string restore_file;        // Checkpoint to resume from, empty to start from reset
+  string fork_server_file;    // Control file of the fork server, empty for none
+  int fork_jobs;              // Children the fork server runs at the same time
+
+  // Default configuration (can be overridden with command-line arguments)
+  SimulationParams();
+};
+
+//---------------------------------------------------------------------------
+// SimulationResults -- outcome of a run, the same written to the results
+// file (see GlobalStats::writeStats())
+struct SimulationResults
 {
-  static int verbose_mode;
-  static int mesh_dim_x;
-  static int mesh_dim_y;
-  static int buffer_depth;
-  static int routing_algorithm;
-  static int simulation_time;
-  static int rnd_generator_seed;
-  static int disr;
-  static int bootstrap;
-  static int bootstrap_timeout;
-  static int ttl;
-  static int bootstrap_immunity;
-  static int cyclelinks;
-  static int graphviz;
-  static double defective_links;
-  static double defective_nodes;
+  int total_nodes;
+  int total_links;
+  int defective_nodes;
+  int covered_nodes;
+  int covered_links;
+  double node_coverage;
+  double link_coverage;
+  double working_link_coverage;
+  int nsegments;
+  double average_seg_length;
+  double latency;
+  int stop_reason;
+  double simulated_cycles;
 };
 
 
@@ -125,18 +189,6 @@ class TCoord
 
 
 
-//---------------------------------------------------------------------------
-// TPayload -- Payload definition
-struct TPayload
-{
-  sc_uint<32>        data;         // Bus for the data to be exchanged
-
-  inline bool operator == (const TPayload& payload) const
-  {
-    return (payload.data==data);
-  }
-};
-
 //---------------------------------------------------------------------------
 // TRouteData -- data required to perform routing
 struct TRouteData
@@ -181,7 +233,7 @@ private:
 	int link;
 
 public:
-	TSegmentId();
+	TSegmentId() : node(NOT_RESERVED), link(NOT_RESERVED) {}
 
 	inline bool operator == (const TSegmentId& segid) const
 	{
@@ -189,7 +241,7 @@ public:
 	}
 	inline bool operator < (const TSegmentId& segid) const
 	{
-	    return ( node<segid.node );
+	    return ( node<segid.node || (node==segid.node && link<segid.link) );
 	}
 
 	inline bool isFree() const
@@ -226,14 +278,15 @@ public:
 
 	}
 
-	int getNode() { return this->node; };
-	int getLink() { return this->link; };
+	int getNode() const { return this->node; };
+	int getLink() const { return this->link; };
 
 };
 
 
 class TPacket;
 class TRouter;
+class TCheckpoint;
 
 
 class DiSR
@@ -243,16 +296,22 @@ class DiSR
     public:
   void reset();
   void update_status();
+  bool needsUpdate() const;
+  int idleCycles() const;
+  void skipCycles(const int cycles);
   int process(TPacket& p);
   void set_router(TRouter *);
   void invalidate_direction(int);
+  void restore();
   void free_direction(int);
   DiSR_status getStatus() const;
-  void setLinks(int type, const vector<int>& directions,const TSegmentId& id);
+  void setLinks(int type, const unsigned int directions,const TSegmentId& id);
   TSegmentId getLocalSegmentID() const;
   TSegmentId getLinkSegmentID(int d) const;
   bool isAssigned() const;
   double get_assign_timestamp() const;
+  void save(TCheckpoint& cp) const;   // LED and DBS state, see TCheckpoint
+  void load(TCheckpoint& cp);
 
 
     private:
@@ -296,18 +355,25 @@ class DiSR
   
 };
 //---------------------------------------------------------------------------
-// TPacket -- Packet definition
+// TPacket -- Packet definition. Copied by value through every channel
+// write and buffer slot, so it is kept trivially copyable and packed in
+// 32 bytes: fields are ordered by size and the small ones narrowed.
+// Note that dir_in/dir_out are chars, cast them to int when printing
 struct TPacket
 {
   TSegmentId	     id;   // required for DiSR 
-  int                src_id;
-  int                dst_id;
-  TPacketType        type;    
-  TPayload           payload;      // Optional payload
-  double             timestamp;    // Unix timestamp at packet generation
-  int                ttl;       // time to live
-  int 		     dir_in;       // The direction it came from
-  int 	        dir_out; // direction to which the packet is forwarded
+  int32_t            src_id;
+  int32_t            dst_id;
+  int32_t            ttl;       // time to live
+  int32_t            timestamp;    // Cycle of packet generation
+  uint32_t           payload;      // Optional payload
+  uint8_t            type;         // TPacketType
+  int8_t 	     dir_in;       // The direction it came from
+  int8_t 	     dir_out; // direction to which the packet is forwarded
+
+  TPacket() : src_id(0), dst_id(0), ttl(0), timestamp(0), payload(0),
+	      type(0), dir_in(0), dir_out(0) {}
+
   inline bool operator == (const TPacket& packet) const
   {
     return (packet.id==id && packet.src_id==src_id && packet.type==type && packet.payload==payload && packet.ttl==ttl);
@@ -319,23 +385,20 @@ struct TPacket
 // output redefinitions *******************************************
 
 //---------------------------------------------------------------------------
+// Packet details, only shown with VERBOSE_HIGH by the callers
 inline ostream& operator << (ostream& os, const TPacket& packet)
 {
-  if (GlobalParams::verbose_mode==VERBOSE_HIGH)
+  os << "### PACKET ###" << endl;
+  os << "Source Node[" << packet.src_id << "]" << endl;
+  switch(packet.type)
   {
-
-      os << "### PACKET ###" << endl;
-      os << "Source Node[" << packet.src_id << "]" << endl;
-      switch(packet.type)
-      {
-	case STARTING_SEGMENT_REQUEST: os << "Packet Type is STARTING_SEGMENT_REQUEST" << endl; break;
-	case SEGMENT_REQUEST: os << "Packet Type is SEGMENT_REQUEST" << endl; break;
-	case SEGMENT_CONFIRM: os << "Packet Type is SEGMENT_CONFIRM" << endl; break;
-	case STARTING_SEGMENT_CONFIRM: os << "Packet Type is STARTING_SEGMENT_CONFIRM" << endl; break;
-	case SEGMENT_CANCEL: os << "Packet Type is SEGMENT_CANCEL" << endl; break;
-      }
-      os << "Time to live:" << packet.ttl << endl;
+    case STARTING_SEGMENT_REQUEST: os << "Packet Type is STARTING_SEGMENT_REQUEST" << endl; break;
+    case SEGMENT_REQUEST: os << "Packet Type is SEGMENT_REQUEST" << endl; break;
+    case SEGMENT_CONFIRM: os << "Packet Type is SEGMENT_CONFIRM" << endl; break;
+    case STARTING_SEGMENT_CONFIRM: os << "Packet Type is STARTING_SEGMENT_CONFIRM" << endl; break;
+    case SEGMENT_CANCEL: os << "Packet Type is SEGMENT_CANCEL" << endl; break;
   }
+  os << "Time to live:" << packet.ttl << endl;
 
   return os;
 }
@@ -359,7 +422,7 @@ inline ostream& operator << (ostream& os, const TCoord& coord)
   return os;
 }
 
-inline ostream& operator << (ostream& os, TSegmentId& segid)
+inline ostream& operator << (ostream& os, const TSegmentId& segid)
 {
     if (segid.isFree())
 	os << "(.)";
@@ -389,25 +452,25 @@ inline void sc_trace(sc_trace_file*& tf, const TChannelStatus& bs, string& name)
 
 // misc common functions **************************************
 //---------------------------------------------------------------------------
-inline TCoord id2Coord(int id) 
+inline TCoord id2Coord(int id, const SimulationParams& params) 
 {
   TCoord coord;
 
-  coord.x = id % GlobalParams::mesh_dim_x;
-  coord.y = id / GlobalParams::mesh_dim_x;
+  coord.x = id % params.mesh_dim_x;
+  coord.y = id / params.mesh_dim_x;
 
-  assert(coord.x < GlobalParams::mesh_dim_x);
-  assert(coord.y < GlobalParams::mesh_dim_y);
+  assert(coord.x < params.mesh_dim_x);
+  assert(coord.y < params.mesh_dim_y);
 
   return coord;
 }
 
 //---------------------------------------------------------------------------
-inline int coord2Id(const TCoord& coord) 
+inline int coord2Id(const TCoord& coord, const SimulationParams& params) 
 {
-  int id = (coord.y * GlobalParams::mesh_dim_x) + coord.x;
+  int id = (coord.y * params.mesh_dim_x) + coord.x;
 
-  assert(id < GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y);
+  assert(id < params.mesh_dim_x * params.mesh_dim_y);
 
   return id;
 }
@@ -3,13 +3,25 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <deque>
 #include <map>
+#include <algorithm>
 #include <string>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <stdint.h>
 #include <cstdlib>
 #include <cstring>
+#include <pthread.h>
+#include "Simulator.h"
+#include "CmdLineParser.h"
 using namespace std;
 
 //---------------------------------------------------------------------------
@@ -21,11 +33,27 @@ using namespace std;
 #define REPETITIONS_LABEL    "repetitions"
 #define PLOT_TYPE_LABEL      "plot_type"
 #define TMP_DIR_LABEL        "tmp"
+#define JOBS_LABEL           "jobs"
+#define SEED_LABEL           "seed"
+#define CACHE_LABEL          "cache"
+#define MIN_REPETITIONS_LABEL "min_repetitions"
+#define MAX_REPETITIONS_LABEL "max_repetitions"
+#define CI_NODE_COVERAGE_LABEL "ci_node_coverage"
+#define CI_LATENCY_LABEL     "ci_latency"
+#define CONFIDENCE_LABEL     "confidence"
+#define SEARCH_LABEL         "search"
+#define SEARCH_TOLERANCE_LABEL "search_tolerance"
 
 #define DEF_SIMULATOR        "./nanoxim"
+#define BUILTIN_SIMULATOR    "builtin"   // The simulator core linked in, see Simulator.h
 #define DEF_REPETITIONS      5
 #define DEF_TMP_DIR          "./"
 #define DEF_PLOT_TYPE        0
+#define DEF_JOBS             1
+#define DEF_SEED             1
+#define DEF_CACHE_DIR        ".nanoxim_cache/"
+#define NO_CACHE             "none"
+#define DEF_CONFIDENCE       0.9    // Same as the ttest() of the Matlab code
 
 #define PLOT_SET1	1
 #define PLOT_SET2	2
@@ -33,7 +61,8 @@ using namespace std;
 
 
 #define TMP_FILE_NAME        ".nanoxim_explorer.tmp"
-#define RES_FILE_NAME        "results.txt"
+#define JOURNAL_SUFFIX       ".journal"
+#define RES_FILE_NAME        ".nanoxim_explorer.res"
 
 #define DEFECTIVE_NODES_LABEL   "defective nodes:"
 #define NODE_COVERAGE_LABEL 	"node coverage:"
@@ -41,6 +70,7 @@ using namespace std;
 #define NUMBER_OF_SEG_LABEL	"number of segments:"
 #define AVERAGE_SEG_LENGTH_LABEL	"average segment length:"
 #define LATENCY_LABEL 	"latency:"
+#define CACHE_KEY_LABEL 	"cache key:"
 
 #define MATLAB_VAR_NAME      "data"
 #define MATRIX_COLUMN_WIDTH  15
@@ -60,12 +90,32 @@ typedef vector<pair<string, string> > TConfiguration;
 
 typedef vector<TConfiguration> TConfigurationSpace;
 
+// The explorer's own output. The simulations run in process print on
+// cout, which is muted in the meantime (see RunJobs())
+ostream console(cout.rdbuf());
+
+// How the explorer was invoked, for the identity of the builtin simulator
+string explorer_path;
+
 struct TExplorerParams
 {
   string simulator;
   string tmp_dir;
   int    repetitions;
+  int    min_repetitions;  // Adaptive mode: at least min and at most
+  int    max_repetitions;  // max repetitions, until the confidence
+  double ci_node_coverage; // intervals are within these half-widths
+  double ci_latency;       // (0 for no target)
+  double confidence;
+  string search_metric;    // Search mode: the value of the aggregated
+  string search_op;        // parameter at which "metric op threshold"
+  double search_threshold; // stops holding, to within search_tolerance
+  double search_tolerance; // (the step of the grid, if 0)
   int plot_type;
+  int    jobs;          // Simulations run concurrently
+  int    seed;          // Seed of the first repetition, the next ones count up
+  string cache_dir;     // Where results are cached, or NO_CACHE
+  string simulator_id;  // Hash of the simulator binary, empty if unknown
 };
 
 struct TSimulationResults
@@ -79,6 +129,97 @@ struct TSimulationResults
 	int latency;
 };
 
+// A single simulation, as scheduled by RunJobs()
+struct TSimulationJob
+{
+  string             cmd;
+  string             cache_key;   // Simulator identity and parameters, see CacheKey()
+  TConfiguration     aggr_conf;
+  TSimulationResults sres;
+  bool               done;
+};
+
+// Mean and variance computed online (Welford)
+struct TRunningStats
+{
+  uint   n;
+  double mean;
+  double m2;      // Sum of the squared differences from the mean
+
+  TRunningStats() : n(0), mean(0), m2(0) {}
+
+  void add(const double x)
+  {
+    double delta = x - mean;
+
+    n++;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+  }
+
+  double variance() const { return n > 1 ? m2 / (n - 1) : 0; }
+};
+
+// An aggregated configuration and its repetitions. The statistics only
+// take in the leading completed repetitions, in seed order, so that when
+// to stop doesn't depend on the order the simulations complete in
+struct TSweepPoint
+{
+  string         cmd;           // All but the seed
+  TConfiguration aggr_conf;
+  vector<TSimulationJob> jobs;  // Repetitions scheduled so far
+  uint           accumulated;   // Leading jobs added to the statistics
+  TRunningStats  node_coverage;
+  TRunningStats  latency;
+  TRunningStats  searched;      // The metric of the search mode
+  double         value;         // Of the searched parameter
+};
+
+// Point, repetition
+typedef pair<uint, uint> TJobIndex;
+
+// Slots whose in-process simulation completed
+struct TCompletions
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  deque<int>      slots;
+};
+
+// A slot running simulations in process. The network is kept from one
+// simulation to the next one of the same point
+struct TWorker
+{
+  int                slot;
+  TCompletions*      completions;
+  pthread_t          thread;
+  Simulator*         simulator;
+  string             point_cmd;   // The point the network was built for
+  bool               rebuild;
+  SimulationParams   params;
+  TSimulationResults sres;
+};
+
+// Runs completed so far, see OpenJournal()
+struct TJournal
+{
+  int fd;
+  map<string, TSimulationResults> replay;   // Results of the previous sweep, by cache key
+
+  TJournal() : fd(-1) {}
+  ~TJournal() { if (fd >= 0) close(fd); }
+};
+
+// Progress of the whole exploration, for the estimated time to finish
+struct TProgress
+{
+  uint   launched;
+  uint   completed;
+  uint   total;
+  uint   simulated;     // Completed ones that actually ran, not found in the cache
+  double busy_time;     // Sum of the wall-clock time of the simulated ones
+};
+
 //---------------------------------------------------------------------------
 
 double GetCurrentTime()
@@ -92,12 +233,12 @@ double GetCurrentTime()
 
 //---------------------------------------------------------------------------
 
-void TimeToFinish(double elapsed_sec,
-		  int completed, int total,
+// The simulations left are spread over the jobs running concurrently
+void TimeToFinish(const TProgress& progress, const int jobs,
 		  int& hours, int& minutes, int &seconds)
 {
-  double total_time_sec = (elapsed_sec * total)/completed;
-  double remain_time_sec = total_time_sec - elapsed_sec;
+  double avg_time_sec = progress.busy_time / progress.simulated;
+  double remain_time_sec = avg_time_sec * (progress.total - progress.completed) / jobs;
 
   seconds = (int)remain_time_sec % 60;
   minutes = ((int)remain_time_sec / 60) % 60;
@@ -457,6 +598,30 @@ string Configuration2FunctionName(const TConfiguration& conf)
 
 //---------------------------------------------------------------------------
 
+bool IsMetric(const string& metric)
+{
+  return (metric == "node_coverage" || metric == "link_coverage" || metric == "nsegments" ||
+	  metric == "avg_seg_length" || metric == "latency");
+}
+
+//---------------------------------------------------------------------------
+
+double MetricValue(const TSimulationResults& sres, const string& metric)
+{
+  if (metric == "node_coverage")
+    return sres.node_coverage;
+  else if (metric == "link_coverage")
+    return sres.link_coverage;
+  else if (metric == "nsegments")
+    return sres.nsegments;
+  else if (metric == "avg_seg_length")
+    return sres.avg_seg_length;
+  else
+    return sres.latency;
+}
+
+//---------------------------------------------------------------------------
+
 bool ExtractExplorerParams(const TParameterSpace& explorer_params,
 			   TExplorerParams& eparams,
 			   string& error_msg)
@@ -465,6 +630,16 @@ bool ExtractExplorerParams(const TParameterSpace& explorer_params,
   eparams.tmp_dir     = DEF_TMP_DIR;
   eparams.repetitions = DEF_REPETITIONS;
   eparams.plot_type = DEF_PLOT_TYPE;
+  eparams.jobs        = DEF_JOBS;
+  eparams.seed        = DEF_SEED;
+  eparams.cache_dir   = DEF_CACHE_DIR;
+  eparams.min_repetitions  = -1;
+  eparams.max_repetitions  = -1;
+  eparams.ci_node_coverage = 0;
+  eparams.ci_latency       = 0;
+  eparams.confidence       = DEF_CONFIDENCE;
+  eparams.search_threshold = 0;
+  eparams.search_tolerance = 0;
 
   for (uint i=0; i<explorer_params.size(); i++)
     {
@@ -481,6 +656,34 @@ bool ExtractExplorerParams(const TParameterSpace& explorer_params,
 	iss >> eparams.tmp_dir;
       else if (label == PLOT_TYPE_LABEL)
 	iss >> eparams.plot_type;
+      else if (label == JOBS_LABEL)
+	iss >> eparams.jobs;
+      else if (label == SEED_LABEL)
+	iss >> eparams.seed;
+      else if (label == CACHE_LABEL)
+	iss >> eparams.cache_dir;
+      else if (label == MIN_REPETITIONS_LABEL)
+	iss >> eparams.min_repetitions;
+      else if (label == MAX_REPETITIONS_LABEL)
+	iss >> eparams.max_repetitions;
+      else if (label == CI_NODE_COVERAGE_LABEL)
+	iss >> eparams.ci_node_coverage;
+      else if (label == CI_LATENCY_LABEL)
+	iss >> eparams.ci_latency;
+      else if (label == CONFIDENCE_LABEL)
+	iss >> eparams.confidence;
+      else if (label == SEARCH_LABEL)
+	{
+	  iss >> eparams.search_metric >> eparams.search_op >> eparams.search_threshold;
+	  if (iss.fail() || !IsMetric(eparams.search_metric) ||
+	      (eparams.search_op != ">=" && eparams.search_op != "<="))
+	    {
+	      error_msg = "Invalid search, should be: " SEARCH_LABEL " <metric> >=|<= <threshold>";
+	      return false;
+	    }
+	}
+      else if (label == SEARCH_TOLERANCE_LABEL)
+	iss >> eparams.search_tolerance;
       else
 	{
 	  error_msg = "Invalid explorer option '" + label + "'";
@@ -488,6 +691,25 @@ bool ExtractExplorerParams(const TParameterSpace& explorer_params,
 	}
     }
 
+  // Without a max_repetitions every configuration gets the same number
+  // of repetitions, as ever
+  if (eparams.min_repetitions < 0)
+    eparams.min_repetitions = eparams.repetitions;
+  if (eparams.max_repetitions < 0)
+    eparams.max_repetitions = eparams.min_repetitions;
+
+  if (eparams.min_repetitions < 1 || eparams.max_repetitions < eparams.min_repetitions)
+    {
+      error_msg = "The repetitions must be 1 <= min_repetitions <= max_repetitions";
+      return false;
+    }
+
+  if (eparams.confidence <= 0 || eparams.confidence >= 1)
+    {
+      error_msg = "The confidence must be between 0 and 1";
+      return false;
+    }
+
   return true;
 }
 
@@ -594,7 +816,7 @@ bool ReadResults(const string& fname,
 
   if (nread != 5)
     {
-	cout << "\n nread = " << nread;
+	console << "\n nread = " << nread;
       error_msg = "Output file " + fname + " corrupted";
       return false;
     }
@@ -604,28 +826,826 @@ bool ReadResults(const string& fname,
 
 //---------------------------------------------------------------------------
 
-bool RunSimulation(const string& cmd_base,
-		   const string& tmp_dir,
-		   TSimulationResults& sres, 
+// Each concurrent job has an output and a results (-out) file of its
+// own, so that simulations don't collide
+string JobFileName(const string& tmp_dir, const string& name, const int slot)
+{
+  ostringstream oss;
+
+  oss << tmp_dir << name << "." << slot;
+
+  return oss.str();
+}
+
+//---------------------------------------------------------------------------
+
+// The simulator is run directly, with no shell in between: the command
+// line is split at blanks and the output redirected by hand
+pid_t LaunchSimulation(const string& cmd_base,
+		       const string& tmp_fname,
+		       const string& res_fname,
+		       string& error_msg)
+{
+  // A simulation that fails must not leave the previous results behind
+  unlink(res_fname.c_str());
+
+  console << cmd_base << " -out " << res_fname << " >" << tmp_fname << " 2>&1" << endl;
+
+  vector<string> args;
+  istringstream iss(cmd_base);
+  string arg;
+  while (iss >> arg)
+    args.push_back(arg);
+  args.push_back("-out");
+  args.push_back(res_fname);
+
+  vector<char *> argv;
+  for (uint i=0; i<args.size(); i++)
+    argv.push_back((char *)args[i].c_str());
+  argv.push_back(NULL);
+
+  pid_t pid = fork();
+
+  if (pid == 0)
+    {
+      int fd = open(tmp_fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd >= 0)
+	{
+	  dup2(fd, STDOUT_FILENO);
+	  dup2(fd, STDERR_FILENO);
+	  close(fd);
+	  execvp(argv[0], &argv[0]);
+	}
+      _exit(127);
+    }
+
+  if (pid < 0)
+    error_msg = "Cannot launch " + cmd_base;
+
+  return pid;
+}
+
+//---------------------------------------------------------------------------
+
+bool CollectSimulation(const string& tmp_fname,
+		       const string& res_fname,
+		       TSimulationResults& sres, 
+		       string& error_msg)
+{
+  if (!ReadResults(res_fname, sres, error_msg))
+    return false;
+
+  unlink(tmp_fname.c_str());
+  unlink(res_fname.c_str());
+
+  return true;
+}
+//---------------------------------------------------------------------------
+
+void* RunInProcess(void *arg)
+{
+  TWorker *worker = (TWorker *)arg;
+
+  if (worker->rebuild)
+    {
+      delete worker->simulator;
+      worker->simulator = new Simulator(worker->params);
+    }
+
+  SimulationResults results = worker->simulator->run(worker->params.rnd_generator_seed);
+
+  worker->sres.node_coverage  = results.node_coverage;
+  worker->sres.link_coverage  = results.link_coverage;
+  worker->sres.nsegments      = results.nsegments;
+  worker->sres.avg_seg_length = results.average_seg_length;
+  worker->sres.latency        = (int)results.latency;
+
+  pthread_mutex_lock(&worker->completions->mutex);
+  worker->completions->slots.push_back(worker->slot);
+  pthread_cond_signal(&worker->completions->cond);
+  pthread_mutex_unlock(&worker->completions->mutex);
+
+  return NULL;
+}
+
+//---------------------------------------------------------------------------
+
+// Runs the simulation on a thread of its own, with the simulator core
+// linked in: the command line is parsed just as the simulator would, but
+// nothing is written or read back
+bool LaunchInProcess(TWorker& worker,
+		     const string& cmd,
+		     const string& point_cmd,
+		     string& error_msg)
+{
+  console << cmd << endl;
+
+  vector<string> args;
+  istringstream iss(cmd);
+  string arg;
+  while (iss >> arg)
+    args.push_back(arg);
+
+  vector<char *> argv;
+  for (uint i=0; i<args.size(); i++)
+    argv.push_back((char *)args[i].c_str());
+  argv.push_back(NULL);
+
+  worker.params = SimulationParams();
+  parseCmdLine(args.size(), &argv[0], worker.params);
+
+  // There is a single SystemC kernel per process. The native engine
+  // gives the same results anyway
+  worker.params.engine = ENGINE_NATIVE;
+
+  // The log goes straight to the standard output, bypassing the muted
+  // cout, and the workers would all write the same trace and checkpoint
+  worker.params.verbose_mode = VERBOSE_OFF;
+  worker.params.trace_file.clear();
+  worker.params.checkpoint_file.clear();
+  worker.params.restore_file.clear();
+
+  worker.rebuild = (worker.simulator == NULL || worker.point_cmd != point_cmd);
+  worker.point_cmd = point_cmd;
+
+  if (pthread_create(&worker.thread, NULL, RunInProcess, &worker) != 0)
+    {
+      error_msg = "Cannot launch " + cmd;
+      return false;
+    }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+uint64_t HashBytes(const char *data, const size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+  // FNV-1a
+  for (size_t i=0; i<size; i++)
+    {
+      hash ^= (unsigned char)data[i];
+      hash *= 1099511628211ULL;
+    }
+
+  return hash;
+}
+
+//---------------------------------------------------------------------------
+
+string HashToString(const uint64_t hash)
+{
+  ostringstream oss;
+
+  oss << hex << setw(16) << setfill('0') << hash;
+
+  return oss.str();
+}
+
+//---------------------------------------------------------------------------
+
+// Identifies the simulator by the hash of its binary, so that a rebuilt
+// one doesn't reuse the results of the previous build
+string SimulatorIdentity(const string& simulator)
+{
+  string path = simulator;
+
+  // Not a path, look for it like execvp() does
+  if (simulator.find('/') == string::npos && getenv("PATH") != NULL)
+    {
+      istringstream iss(getenv("PATH"));
+      string dir;
+
+      while (getline(iss, dir, ':'))
+	if (access((dir + "/" + simulator).c_str(), X_OK) == 0)
+	  {
+	    path = dir + "/" + simulator;
+	    break;
+	  }
+    }
+
+  ifstream fin(path.c_str(), ios::in | ios::binary);
+  if (!fin)
+    return "";
+
+  uint64_t hash = HashBytes(NULL, 0);
+  char     buffer[65536];
+
+  while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0)
+    hash = HashBytes(buffer, fin.gcount(), hash);
+
+  return HashToString(hash);
+}
+
+//---------------------------------------------------------------------------
+
+// Everything that determines the results of a simulation: the simulator
+// binary and the arguments (which include the seed), blanks normalized
+string CacheKey(const TExplorerParams& eparams, const string& cmd)
+{
+  istringstream iss(cmd);
+  string arg, key = eparams.simulator_id;
+
+  iss >> arg; // the simulator path doesn't matter, its identity does
+  while (iss >> arg)
+    key = key + " " + arg;
+
+  return key;
+}
+
+//---------------------------------------------------------------------------
+
+string CacheFileName(const TExplorerParams& eparams, const string& key)
+{
+  return eparams.cache_dir + HashToString(HashBytes(key.c_str(), key.size()));
+}
+
+//---------------------------------------------------------------------------
+
+bool UseCache(const TExplorerParams& eparams)
+{
+  return eparams.cache_dir != NO_CACHE && !eparams.simulator_id.empty();
+}
+
+//---------------------------------------------------------------------------
+
+bool LookupCache(const TExplorerParams& eparams,
+		 TSimulationJob& job)
+{
+  if (!UseCache(eparams))
+    return false;
+
+  string fname = CacheFileName(eparams, job.cache_key);
+  ifstream fin(fname.c_str(), ios::in);
+  if (!fin)
+    return false;
+
+  // Guard against hash collisions
+  string line;
+  getline(fin, line);
+  if (line != string(CACHE_KEY_LABEL) + " " + job.cache_key)
+    return false;
+  fin.close();
+
+  string error_msg;
+  return ReadResults(fname, job.sres, error_msg);
+}
+
+//---------------------------------------------------------------------------
+
+// Entries are written to a temporary file and then renamed, so that a
+// reader never finds a partial one
+void StoreCache(const TExplorerParams& eparams,
+		const TSimulationJob& job)
+{
+  if (!UseCache(eparams))
+    return;
+
+  if (mkdir(eparams.cache_dir.c_str(), 0755) != 0 && errno != EEXIST)
+    return;
+
+  string fname = CacheFileName(eparams, job.cache_key);
+  ostringstream tmp_fname;
+  tmp_fname << fname << ".tmp." << getpid();
+
+  ofstream fout(tmp_fname.str().c_str(), ios::out);
+  if (!fout)
+    return;
+
+  fout << CACHE_KEY_LABEL << " " << job.cache_key << endl
+       << NODE_COVERAGE_LABEL << " " << job.sres.node_coverage << endl
+       << LINK_COVERAGE_LABEL << " " << job.sres.link_coverage << endl
+       << NUMBER_OF_SEG_LABEL << " " << job.sres.nsegments << endl
+       << AVERAGE_SEG_LENGTH_LABEL << " " << job.sres.avg_seg_length << endl
+       << LATENCY_LABEL << " " << job.sres.latency << endl;
+  fout.close();
+
+  if (!fout || rename(tmp_fname.str().c_str(), fname.c_str()) != 0)
+    unlink(tmp_fname.str().c_str());
+}
+
+//---------------------------------------------------------------------------
+
+// The journal records each simulation as soon as its results are
+// known, one line per simulation (seed, results and then the cache key)
+// synced to disk before going on. When resuming, the records of the
+// previous sweep are loaded and appended to, otherwise the journal
+// starts over
+bool OpenJournal(const string& fname,
+		 const bool resume,
+		 TJournal& journal,
+		 string& error_msg)
+{
+  journal.replay.clear();
+
+  off_t complete_size = 0;    // Up to the last complete record
+
+  if (resume)
+    {
+      ifstream fin(fname.c_str(), ios::in);
+      string line;
+
+      // A record cut short by a crash has no newline, and is dropped
+      while (getline(fin, line) && !fin.eof())
+	{
+	  complete_size += line.size() + 1;
+
+	  istringstream iss(line);
+	  string seed_label, results_label, key_label, key;
+	  int seed;
+	  TSimulationResults sres;
+
+	  iss >> seed_label >> seed >> results_label
+	      >> sres.node_coverage >> sres.link_coverage >> sres.nsegments
+	      >> sres.avg_seg_length >> sres.latency >> key_label;
+	  getline(iss, key);
+
+	  if (!iss.fail() && seed_label == SEED_LABEL && key_label == "key" && key.size() > 1)
+	    journal.replay[key.substr(1)] = sres;
+	}
+
+      console << "# resuming, " << journal.replay.size() << " simulations found in " << fname << endl;
+    }
+
+  journal.fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_APPEND | (resume ? 0 : O_TRUNC), 0644);
+  if (journal.fd < 0 || ftruncate(journal.fd, complete_size) != 0)
+    {
+      error_msg = "Cannot open " + fname;
+      return false;
+    }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool AppendJournal(TJournal& journal,
+		   const TSimulationJob& job,
 		   string& error_msg)
 {
-  string tmp_fname = tmp_dir + TMP_FILE_NAME;
-  //  string cmd = cmd_base + " >& " + tmp_fname; // this works only with csh and bash
-  string cmd = cmd_base + " >" + tmp_fname + " 2>&1"; // this works with sh, csh, and bash!
+  // The seed is the last argument, see RunSimulations()
+  string seed = job.cmd.substr(job.cmd.rfind(' ') + 1);
+
+  ostringstream oss;
+  oss << SEED_LABEL << " " << seed << " results "
+      << job.sres.node_coverage << " " << job.sres.link_coverage << " "
+      << job.sres.nsegments << " " << job.sres.avg_seg_length << " "
+      << job.sres.latency << " key " << job.cache_key << endl;
+
+  string record = oss.str();
+
+  if (write(journal.fd, record.c_str(), record.size()) != (ssize_t)record.size() ||
+      fsync(journal.fd) != 0)
+    {
+      error_msg = "Cannot write the journal";
+      return false;
+    }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool ReplayJournal(const TJournal& journal,
+		   TSimulationJob& job)
+{
+  map<string, TSimulationResults>::const_iterator i = journal.replay.find(job.cache_key);
 
-  cout << cmd << endl;
-  system(cmd.c_str());
-  if (!ReadResults(RES_FILE_NAME, sres, error_msg))
+  if (i == journal.replay.end())
     return false;
 
-  string rm_cmd = string("rm -f ") + tmp_fname;
-  system(rm_cmd.c_str());
+  job.sres = i->second;
 
   return true;
 }
 
 //---------------------------------------------------------------------------
 
+// Regularized incomplete beta function I_x(a,b), by its continued
+// fraction (modified Lentz)
+double IncompleteBeta(const double a, const double b, const double x)
+{
+  if (x <= 0)
+    return 0;
+  if (x >= 1)
+    return 1;
+
+  // The fraction converges quickly for x < (a+1)/(a+b+2) only
+  if (x > (a + 1) / (a + b + 2))
+    return 1 - IncompleteBeta(b, a, 1 - x);
+
+  const double tiny = 1.0e-300;
+  double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x)) / a;
+  double c = 1, d = 0, f = 1;
+
+  for (int i=0; i<=400; i++)
+    {
+      int    m = i / 2;
+      double numerator;
+
+      if (i == 0)
+	numerator = 1;
+      else if (i % 2 == 0)
+	numerator = (m * (b - m) * x) / ((a + 2*m - 1) * (a + 2*m));
+      else
+	numerator = -((a + m) * (a + b + m) * x) / ((a + 2*m) * (a + 2*m + 1));
+
+      d = 1 + numerator * d;
+      if (fabs(d) < tiny)
+	d = tiny;
+      d = 1 / d;
+
+      c = 1 + numerator / c;
+      if (fabs(c) < tiny)
+	c = tiny;
+
+      double delta = c * d;
+      f *= delta;
+
+      if (fabs(1 - delta) < 1.0e-12)
+	break;
+    }
+
+  return front * (f - 1);
+}
+
+//---------------------------------------------------------------------------
+
+// Quantile p (> 0.5) of the Student's t distribution with df degrees of
+// freedom, by bisection of its cumulative distribution function
+double StudentQuantile(const double p, const int df)
+{
+  double lo = 0, hi = 1;
+
+  // P(T <= t) = 1 - I_{df/(df+t^2)}(df/2, 1/2) / 2, for t >= 0
+  while (1 - IncompleteBeta(df / 2.0, 0.5, df / (df + hi * hi)) / 2 < p)
+    hi *= 2;
+
+  for (int i=0; i<100; i++)
+    {
+      double t = (lo + hi) / 2;
+
+      if (1 - IncompleteBeta(df / 2.0, 0.5, df / (df + t * t)) / 2 < p)
+	lo = t;
+      else
+	hi = t;
+    }
+
+  return (lo + hi) / 2;
+}
+
+//---------------------------------------------------------------------------
+
+// Half-width of the confidence interval of the mean, as ttest() computes it
+double ConfidenceHalfWidth(const TRunningStats& stats, const double confidence)
+{
+  if (stats.n < 2)
+    return HUGE_VAL;
+
+  return StudentQuantile((1 + confidence) / 2, stats.n - 1) * sqrt(stats.variance() / stats.n);
+}
+
+//---------------------------------------------------------------------------
+
+// Whether "metric op threshold" holds at the point, as far as the
+// confidence interval of the metric can tell: 1 (it holds), 0 (it
+// doesn't) or -1 (too close to call)
+int PredicateHolds(const TExplorerParams& eparams,
+		   const TSweepPoint& point)
+{
+  double half_width = ConfidenceHalfWidth(point.searched, eparams.confidence);
+  double low  = point.searched.mean - half_width;
+  double high = point.searched.mean + half_width;
+
+  if (eparams.search_op == ">=")
+    {
+      if (low >= eparams.search_threshold)
+	return 1;
+      if (high < eparams.search_threshold)
+	return 0;
+    }
+  else
+    {
+      if (high <= eparams.search_threshold)
+	return 1;
+      if (low > eparams.search_threshold)
+	return 0;
+    }
+
+  return -1;
+}
+
+//---------------------------------------------------------------------------
+
+// Same as PredicateHolds(), going by the mean when too close to call
+bool PredicateOutcome(const TExplorerParams& eparams,
+		      const TSweepPoint& point)
+{
+  int holds = PredicateHolds(eparams, point);
+
+  if (holds >= 0)
+    return holds == 1;
+
+  if (eparams.search_op == ">=")
+    return point.searched.mean >= eparams.search_threshold;
+  else
+    return point.searched.mean <= eparams.search_threshold;
+}
+
+//---------------------------------------------------------------------------
+
+// Whether the point has to be sampled again, judging by the repetitions
+// scheduled so far (all of them completed)
+bool NeedsRepetition(const TExplorerParams& eparams,
+		     const TSweepPoint& point)
+{
+  if (point.jobs.size() < (uint)eparams.min_repetitions)
+    return true;
+
+  if (point.jobs.size() >= (uint)eparams.max_repetitions)
+    return false;
+
+  if (eparams.ci_node_coverage > 0 &&
+      ConfidenceHalfWidth(point.node_coverage, eparams.confidence) > eparams.ci_node_coverage)
+    return true;
+
+  if (eparams.ci_latency > 0 &&
+      ConfidenceHalfWidth(point.latency, eparams.confidence) > eparams.ci_latency)
+    return true;
+
+  if (!eparams.search_metric.empty())
+    return PredicateHolds(eparams, point) < 0;
+
+  return false;
+}
+
+//---------------------------------------------------------------------------
+
+// Schedules the next repetition of a point. Explicit seeds make the
+// repetitions reproducible (and cacheable). They come last, so they
+// override any other one
+void AddRepetition(const TExplorerParams& eparams,
+		   vector<TSweepPoint>& points,
+		   const uint p,
+		   deque<TJobIndex>& pending)
+{
+  TSweepPoint& point = points[p];
+  ostringstream seed;
+  seed << " -seed " << eparams.seed + point.jobs.size();
+
+  TSimulationJob job;
+  job.cmd = point.cmd + seed.str();
+  job.cache_key = CacheKey(eparams, job.cmd);
+  job.aggr_conf = point.aggr_conf;
+  job.done = false;
+
+  pending.push_back(TJobIndex(p, point.jobs.size()));
+  point.jobs.push_back(job);
+}
+
+//---------------------------------------------------------------------------
+
+// Takes in the results of a repetition and, once all of the point's are
+// in, decides whether it needs one more
+void CompleteJob(const TExplorerParams& eparams,
+		 vector<TSweepPoint>& points,
+		 const TJobIndex& ji,
+		 deque<TJobIndex>& pending,
+		 TProgress& progress)
+{
+  TSweepPoint& point = points[ji.first];
+
+  point.jobs[ji.second].done = true;
+  progress.completed++;
+
+  while (point.accumulated < point.jobs.size() && point.jobs[point.accumulated].done)
+    {
+      const TSimulationResults& sres = point.jobs[point.accumulated++].sres;
+
+      point.node_coverage.add(sres.node_coverage);
+      point.latency.add(sres.latency);
+      if (!eparams.search_metric.empty())
+	point.searched.add(MetricValue(sres, eparams.search_metric));
+    }
+
+  if (point.accumulated < point.jobs.size())
+    return;
+
+  if (NeedsRepetition(eparams, point))
+    {
+      AddRepetition(eparams, points, ji.first, pending);
+      progress.total++;
+    }
+  else if (eparams.max_repetitions > eparams.min_repetitions)
+    console << "# " << Configuration2CmdLine(point.aggr_conf) << "done after "
+	    << point.jobs.size() << " repetitions, node coverage "
+	    << point.node_coverage.mean << " +/- " << ConfidenceHalfWidth(point.node_coverage, eparams.confidence)
+	    << ", latency "
+	    << point.latency.mean << " +/- " << ConfidenceHalfWidth(point.latency, eparams.confidence)
+	    << endl;
+}
+
+//---------------------------------------------------------------------------
+
+// Runs the repetitions of the points, up to eparams.jobs at a time, each
+// one as a child process or, with the builtin simulator, on a thread of
+// its own. The results are stored in the jobs themselves,
+// so that they can be written in the original order whatever the
+// completion one. In the adaptive mode progress.total grows as the
+// points turn out to need more repetitions
+bool RunJobs(vector<TSweepPoint>& points,
+	     const TExplorerParams& eparams,
+	     TJournal& journal,
+	     TProgress& progress,
+	     string& error_msg)
+{
+  bool builtin = (eparams.simulator == BUILTIN_SIMULATOR);
+
+  vector<char>      slot_busy(eparams.jobs, 0);
+  vector<pid_t>     slot_pid(eparams.jobs, 0);
+  vector<TJobIndex> slot_job(eparams.jobs);
+  vector<double>    slot_start(eparams.jobs);
+  vector<TWorker>   workers(eparams.jobs);
+  TCompletions      completions;
+  streambuf        *cout_buf = NULL;
+  deque<TJobIndex>  pending;
+  int  running = 0;
+  bool failed = false;
+
+  if (builtin)
+    {
+      pthread_mutex_init(&completions.mutex, NULL);
+      pthread_cond_init(&completions.cond, NULL);
+
+      for (int slot=0; slot<eparams.jobs; slot++)
+	{
+	  workers[slot].slot = slot;
+	  workers[slot].completions = &completions;
+	  workers[slot].simulator = NULL;
+	}
+
+      // Nobody is there to read what the simulations print
+      cout_buf = cout.rdbuf(NULL);
+    }
+
+  for (uint p=0; p<points.size(); p++)
+    for (int r=0; r<eparams.min_repetitions; r++)
+      AddRepetition(eparams, points, p, pending);
+
+  while (running > 0 || (!pending.empty() && !failed))
+    {
+      // Fill the free slots
+      for (int slot=0; slot<eparams.jobs && !pending.empty() && !failed; slot++)
+	{
+	  if (slot_busy[slot])
+	    continue;
+
+	  // Skip the ones already simulated by this (resumed) sweep or an
+	  // earlier one
+	  while (!pending.empty() && !failed)
+	    {
+	      TJobIndex       ji = pending.front();
+	      TSimulationJob& job = points[ji.first].jobs[ji.second];
+
+	      if (ReplayJournal(journal, job))
+		console << "# simulation " << (++progress.launched) << " of " << progress.total
+		        << " found in the journal" << endl;
+	      else if (LookupCache(eparams, job))
+		{
+		  console << "# simulation " << (++progress.launched) << " of " << progress.total
+		          << " found in the cache" << endl;
+		  if (!AppendJournal(journal, job, error_msg))
+		    failed = true;
+		}
+	      else
+		break;
+
+	      pending.pop_front();
+	      CompleteJob(eparams, points, ji, pending, progress);
+	    }
+
+	  if (failed || pending.empty())
+	    break;
+
+	  console << "# simulation " << (++progress.launched) << " of " << progress.total;
+	  if (progress.simulated != 0)
+	    {
+	      int h, m, s;
+	      TimeToFinish(progress, eparams.jobs, h, m, s);
+	      console << ", estimated time to finish " << h << "h " << m << "m " << s << "s";
+	    }
+	  console << endl;
+
+	  TJobIndex ji = pending.front();
+	  const string& cmd = points[ji.first].jobs[ji.second].cmd;
+
+	  if (builtin)
+	    {
+	      if (!LaunchInProcess(workers[slot], cmd, points[ji.first].cmd, error_msg))
+		{
+		  failed = true;
+		  break;
+		}
+	    }
+	  else
+	    {
+	      slot_pid[slot] = LaunchSimulation(cmd,
+						JobFileName(eparams.tmp_dir, TMP_FILE_NAME, slot),
+						JobFileName(eparams.tmp_dir, RES_FILE_NAME, slot),
+						error_msg);
+	      if (slot_pid[slot] < 0)
+		{
+		  failed = true;
+		  break;
+		}
+	    }
+
+	  pending.pop_front();
+	  slot_busy[slot] = 1;
+	  slot_job[slot] = ji;
+	  slot_start[slot] = GetCurrentTime();
+	  running++;
+	}
+
+      if (running == 0)
+	break;
+
+      // Wait for any of them to complete
+      int slot = -1;
+
+      if (builtin)
+	{
+	  pthread_mutex_lock(&completions.mutex);
+	  while (completions.slots.empty())
+	    pthread_cond_wait(&completions.cond, &completions.mutex);
+	  slot = completions.slots.front();
+	  completions.slots.pop_front();
+	  pthread_mutex_unlock(&completions.mutex);
+
+	  pthread_join(workers[slot].thread, NULL);
+	}
+      else
+	{
+	  int   status;
+	  pid_t pid = wait(&status);
+	  if (pid < 0)
+	    {
+	      error_msg = "Lost track of the running simulations";
+	      return false;
+	    }
+
+	  for (int s=0; s<eparams.jobs; s++)
+	    if (slot_busy[s] && slot_pid[s] == pid)
+	      slot = s;
+
+	  if (slot < 0)
+	    continue;
+	}
+
+      slot_busy[slot] = 0;
+      running--;
+
+      progress.simulated++;
+      progress.busy_time += GetCurrentTime() - slot_start[slot];
+
+      if (failed)
+	continue;
+
+      TSimulationJob& job = points[slot_job[slot].first].jobs[slot_job[slot].second];
+
+      bool collected = true;
+      if (builtin)
+	job.sres = workers[slot].sres;
+      else
+	collected = CollectSimulation(JobFileName(eparams.tmp_dir, TMP_FILE_NAME, slot),
+				      JobFileName(eparams.tmp_dir, RES_FILE_NAME, slot),
+				      job.sres, error_msg);
+
+      if (collected && AppendJournal(journal, job, error_msg))
+	{
+	  StoreCache(eparams, job);
+	  CompleteJob(eparams, points, slot_job[slot], pending, progress);
+	}
+      else
+	failed = true;
+    }
+
+  if (builtin)
+    {
+      cout.rdbuf(cout_buf);
+
+      for (int slot=0; slot<eparams.jobs; slot++)
+	delete workers[slot].simulator;
+
+      pthread_cond_destroy(&completions.cond);
+      pthread_mutex_destroy(&completions.mutex);
+    }
+
+  return !failed;
+}
+
+//---------------------------------------------------------------------------
+
 string ExtractFirstField(const string& s)
 {
   istringstream iss(s);
@@ -636,47 +1656,147 @@ string ExtractFirstField(const string& s)
 
   return sfirst;
 }
+//---------------------------------------------------------------------------
+
+TSweepPoint MakeSweepPoint(const TExplorerParams& eparams,
+			   const TConfiguration&  aggr_conf,
+			   const string&          def_cmd_line,
+			   const string&          conf_cmd_line)
+{
+  TSweepPoint point;
+
+  point.cmd = eparams.simulator + " "
+    + Configuration2CmdLine(aggr_conf) + " "
+    + def_cmd_line + " "
+    + conf_cmd_line;
+  point.aggr_conf = aggr_conf;
+  point.accumulated = 0;
+  point.value = aggr_conf.empty() ? 0 : atof(ExtractFirstField(aggr_conf[0].second).c_str());
+
+  return point;
+}
 
 //---------------------------------------------------------------------------
 
-bool RunSimulations(double start_time,
-		    pair<uint,uint>& sim_counter,
-		    const string& cmd, const string& tmp_dir, const int repetitions,
-		    const TConfiguration& aggr_conf, 
-		    ofstream& fout, 
-		    string& error_msg)
+bool SortByValue(const TSweepPoint& a, const TSweepPoint& b)
 {
-  int    h, m, s;
-  
-  for (int i=0; i<repetitions; i++)
+  return a.value < b.value;
+}
+
+//---------------------------------------------------------------------------
+
+// Looks for the value of the (only) aggregated parameter at which the
+// predicate of the search changes outcome, within the first and last
+// value of its range. Each round simulates as many points as the jobs,
+// evenly spaced in the bracket left by the previous one, and keeps the
+// stretch between the last point with the outcome of the first value
+// and the next one. Every point is sampled until its confidence interval
+// is clear of the threshold, or max_repetitions is reached. All the
+// points simulated are returned, sorted, and the final bracket in
+// below/above, or false in found if the outcome never changes
+bool SearchThreshold(const TExplorerParams&  eparams,
+		     const string&           parameter,
+		     const TParameterSpace&  range,
+		     const string&           def_cmd_line,
+		     const string&           conf_cmd_line,
+		     TJournal&               journal,
+		     TProgress&              progress,
+		     vector<TSweepPoint>&    points,
+		     bool&                   found,
+		     double&                 below,
+		     double&                 above,
+		     string&                 error_msg)
+{
+  // The range ends keep the spelling of the grid, so that cached grid
+  // simulations are reused
+  TParameterSpace values;
+  values.push_back(range.front());
+  values.push_back(range.back());
+
+  double tolerance = eparams.search_tolerance;
+  if (tolerance <= 0)
+    tolerance = fabs(atof(range[1].c_str()) - atof(range[0].c_str()));
+
+  bool first_outcome = false;
+
+  found = false;
+
+  while (!values.empty())
     {
-      cout << "# simulation " << (++sim_counter.first) << " of " << sim_counter.second;
-      if (i != 0)
-	cout << ", estimated time to finish " << h << "h " << m << "m " << s << "s";
-      cout << endl;
+      vector<TSweepPoint> round;
+      for (uint i=0; i<values.size(); i++)
+	round.push_back(MakeSweepPoint(eparams, TConfiguration(1, make_pair(parameter, values[i])),
+				       def_cmd_line, conf_cmd_line));
+
+      progress.total += round.size() * eparams.min_repetitions;
 
-      TSimulationResults sres;
-      if (!RunSimulation(cmd, tmp_dir, sres, error_msg))
+      if (!RunJobs(round, eparams, journal, progress, error_msg))
 	return false;
 
-      double current_time = GetCurrentTime();
-      TimeToFinish(current_time-start_time, sim_counter.first, sim_counter.second, h, m, s);
-
-      // Print aggragated parameters
-      fout << "  ";
-      for (uint i=0; i<aggr_conf.size(); i++)
-	fout << setw(MATRIX_COLUMN_WIDTH) << ExtractFirstField(aggr_conf[i].second); // this fix the problem with pir
-      // fout << setw(MATRIX_COLUMN_WIDTH) << aggr_conf[i].second;
-
-      // Print results;
-      fout << setw(MATRIX_COLUMN_WIDTH) << sres.node_coverage
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.link_coverage
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.nsegments
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.avg_seg_length
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.latency
-	   << endl;
+      if (points.empty())
+	{
+	  // The range ends
+	  first_outcome = PredicateOutcome(eparams, round[0]);
+	  found = PredicateOutcome(eparams, round[1]) != first_outcome;
+	  below = round[0].value;
+	  above = round[1].value;
+	}
+      else
+	{
+	  uint i;
+	  for (i=0; i<round.size() && PredicateOutcome(eparams, round[i]) == first_outcome; i++)
+	    below = round[i].value;
+	  if (i < round.size())
+	    above = round[i].value;
+	}
+
+      points.insert(points.end(), round.begin(), round.end());
+
+      values.clear();
+      if (found && fabs(above - below) > tolerance)
+	for (int i=1; i<=eparams.jobs; i++)
+	  {
+	    ostringstream oss;
+	    oss << below + (above - below) * i / (eparams.jobs + 1);
+	    values.push_back(oss.str());
+	  }
     }
 
+  sort(points.begin(), points.end(), SortByValue);
+
+  console << "# search: " << eparams.search_metric << " " << eparams.search_op << " "
+          << eparams.search_threshold;
+  if (found)
+    console << " changes outcome between " << parameter << " " << below << " and " << above << endl;
+  else
+    console << " has the same outcome over the whole " << parameter << " range" << endl;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool PrintSimulationResults(const TSimulationJob& job,
+			    ofstream& fout, 
+			    string& error_msg)
+{
+  const TConfiguration&     aggr_conf = job.aggr_conf;
+  const TSimulationResults& sres = job.sres;
+
+  // Print aggragated parameters
+  fout << "  ";
+  for (uint i=0; i<aggr_conf.size(); i++)
+    fout << setw(MATRIX_COLUMN_WIDTH) << ExtractFirstField(aggr_conf[i].second); // this fix the problem with pir
+  // fout << setw(MATRIX_COLUMN_WIDTH) << aggr_conf[i].second;
+
+  // Print results;
+  fout << setw(MATRIX_COLUMN_WIDTH) << sres.node_coverage
+       << setw(MATRIX_COLUMN_WIDTH) << sres.link_coverage
+       << setw(MATRIX_COLUMN_WIDTH) << sres.nsegments
+       << setw(MATRIX_COLUMN_WIDTH) << sres.avg_seg_length
+       << setw(MATRIX_COLUMN_WIDTH) << sres.latency
+       << endl;
+
   return true;
 }
 
@@ -732,7 +1852,9 @@ bool GenMatlabCodeSaturationAnalysis(const string& var_name,
 
 //---------------------------------------------------------------------------
 */
-bool PrintMatlabVariableEnd(const int repetitions, const int plot_type,
+// The rows of the data matrix come in groups, one for each aggregated
+// configuration, of as many rows as its repetitions
+bool PrintMatlabVariableEnd(const vector<uint>& repetitions, const int plot_type,
 			    ofstream& fout, string& error_msg)
 {
 
@@ -766,10 +1888,17 @@ bool PrintMatlabVariableEnd(const int repetitions, const int plot_type,
 
     // number of outputs
   int out_col = 5;
+  fout << "repetitions = [";
+  for (uint i=0; i<repetitions.size(); i++)
+    fout << (i ? " " : "") << repetitions[i];
+  fout << "];" << endl
+       << endl;
+
   fout << ylabel << " = [];" << endl
-       << "for i = 1:rows/" << repetitions << "," << endl
-       << "   ifirst = (i - 1) * " << repetitions << " + 1;" << endl
-       << "   ilast  = ifirst + " << repetitions << " - 1;" << endl
+       << "ilast = 0;" << endl
+       << "for i = 1:length(repetitions)," << endl
+       << "   ifirst = ilast + 1;" << endl
+       << "   ilast  = ilast + repetitions(i);" << endl
        << "   tmp = " << MATLAB_VAR_NAME << "(ifirst:ilast, cols-" << out_col <<"+" << plot_column << ");" << endl
        << "   avg = mean(tmp);" << endl
        << "   [h sig ci] = ttest(tmp, 0.1);" << endl
@@ -822,6 +1951,7 @@ bool RunSimulations(const string& script_fname,
 		    const TParameterSpace&     default_params,
 		    const TParametersSpace&    aggragated_params_space,
 		    const TParameterSpace&     explorer_params,
+		    const bool                 resume,
 		    string&                    error_msg)
 {
   TExplorerParams eparams;
@@ -836,9 +1966,38 @@ bool RunSimulations(const string& script_fname,
   // Explore configuration space
   TConfigurationSpace aggr_conf_space = Explore(aggragated_params_space);
 
-  pair<uint,uint> sim_counter(0, conf_space.size() * aggr_conf_space.size() * eparams.repetitions);
-  
-  double start_time = GetCurrentTime();
+  if (eparams.jobs < 1)
+    {
+      error_msg = "The number of jobs must be >= 1";
+      return false;
+    }
+
+  // The search mode bisects the range of the aggregated parameter, rather
+  // than simulating all of its values
+  bool search = !eparams.search_metric.empty();
+
+  if (search && (aggragated_params_space.size() != 1 ||
+		 aggragated_params_space.begin()->second.size() < 2))
+    {
+      error_msg = "The search mode needs a single aggregated parameter, with a range of values";
+      return false;
+    }
+
+  TProgress progress;
+  progress.launched  = 0;
+  progress.completed = 0;
+  progress.total     = search ? 0 : conf_space.size() * aggr_conf_space.size() * eparams.min_repetitions;
+  progress.simulated = 0;
+  progress.busy_time = 0;
+
+  // Also part of the journal keys
+  eparams.simulator_id = SimulatorIdentity(eparams.simulator == BUILTIN_SIMULATOR ?
+					   explorer_path : eparams.simulator);
+
+  TJournal journal;
+  if (!OpenJournal(script_fname + JOURNAL_SUFFIX, resume, journal, error_msg))
+    return false;
+
   for (uint i=0; i<conf_space.size(); i++)
     {
       string conf_cmd_line = Configuration2CmdLine(conf_space[i]);
@@ -856,28 +2015,56 @@ bool RunSimulations(const string& script_fname,
       if (!PrintMatlabVariableBegin(aggragated_params_space, fout, error_msg))
 	return false;
 
-      for (uint j=0; j<aggr_conf_space.size(); j++)
-	{
-	  string aggr_cmd_line = Configuration2CmdLine(aggr_conf_space[j]);
+      vector<TSweepPoint> points;
+      bool   found;
+      double below, above;
 
-	  string cmd = eparams.simulator + " "
-            + aggr_cmd_line + " "
-	    + def_cmd_line + " "
-	    + conf_cmd_line;
+      if (search)
+	{
+	  if (!SearchThreshold(eparams, aggragated_params_space.begin()->first,
+			       aggragated_params_space.begin()->second,
+			       def_cmd_line, conf_cmd_line, journal, progress,
+			       points, found, below, above, error_msg))
+	    return false;
+	}
+      else
+	{
+	  for (uint j=0; j<aggr_conf_space.size(); j++)
+	    points.push_back(MakeSweepPoint(eparams, aggr_conf_space[j],
+					    def_cmd_line, conf_cmd_line));
 
-	  if (!RunSimulations(start_time,
-			      sim_counter, cmd, eparams.tmp_dir, eparams.repetitions,
-			      aggr_conf_space[j], fout, error_msg))
+	  if (!RunJobs(points, eparams, journal, progress, error_msg))
 	    return false;
 	}
 
+      vector<uint> repetitions;
+
+      for (uint j=0; j<points.size(); j++)
+	{
+	  for (uint r=0; r<points[j].jobs.size(); r++)
+	    if (!PrintSimulationResults(points[j].jobs[r], fout, error_msg))
+	      return false;
+
+	  repetitions.push_back(points[j].jobs.size());
+	}
+
       fout << "];" << endl << endl;
 
       fout << "rows = size(" << MATLAB_VAR_NAME << ", 1);" << endl
 	   << "cols = size(" << MATLAB_VAR_NAME << ", 2);" << endl
 	   << endl;
 
-      if (!PrintMatlabVariableEnd(eparams.repetitions, eparams.plot_type,fout, error_msg))
+      // Where the predicate of the search changes outcome, empty if nowhere
+      if (search)
+	{
+	  fout << "threshold = [";
+	  if (found)
+	    fout << below << " " << above;
+	  fout << "];" << endl
+	       << endl;
+	}
+
+      if (!PrintMatlabVariableEnd(repetitions, eparams.plot_type,fout, error_msg))
 	return false;
     }
 
@@ -887,6 +2074,8 @@ bool RunSimulations(const string& script_fname,
 //---------------------------------------------------------------------------
 
 bool RunSimulations(const string& script_fname,
+		    const int     jobs,
+		    const bool    resume,
 		    string&       error_msg)
 {
   TParametersSpace ps;
@@ -897,13 +2086,13 @@ bool RunSimulations(const string& script_fname,
 
   TParameterSpace default_params;
   if (!RemoveParameter(ps, DEFAULT_KEY, default_params, error_msg))
-    cout << "Warning: " << error_msg << endl;
+    console << "Warning: " << error_msg << endl;
   
 
   TParameterSpace  aggregated_params;
   TParametersSpace aggragated_params_space;
   if (!RemoveParameter(ps, AGGREGATION_KEY, aggregated_params, error_msg))
-    cout << "Warning: " << error_msg << endl;
+    console << "Warning: " << error_msg << endl;
   else
     if (!RemoveAggregateParameters(ps, aggregated_params, 
 				  aggragated_params_space, error_msg))
@@ -911,12 +2100,20 @@ bool RunSimulations(const string& script_fname,
 
   TParameterSpace explorer_params;
   if (!RemoveParameter(ps, EXPLORER_KEY, explorer_params, error_msg))
-    cout << "Warning: " << error_msg << endl;
+    console << "Warning: " << error_msg << endl;
+
+  // The command line overrides the jobs of the configuration file
+  if (jobs > 0)
+    {
+      ostringstream oss;
+      oss << JOBS_LABEL << " " << jobs;
+      explorer_params.push_back(oss.str());
+    }
 
   TConfigurationSpace conf_space = Explore(ps);
 
   if (!RunSimulations(script_fname, conf_space, default_params, 
-		      aggragated_params_space, explorer_params, error_msg))
+		      aggragated_params_space, explorer_params, resume, error_msg))
     return false;
 
 
@@ -928,23 +2125,53 @@ bool RunSimulations(const string& script_fname,
 
 int main(int argc, char **argv)
 {
-  if (argc < 2)
+  int  first_cfg = 1;
+  int  jobs = 0;
+  bool resume = false;
+
+  explorer_path = argv[0];
+
+  // Options come before the configuration files
+  while (first_cfg < argc && argv[first_cfg][0] == '-')
+    {
+      if (!strcmp(argv[first_cfg], "-j") && first_cfg+1 < argc)
+	{
+	  jobs = atoi(argv[++first_cfg]);
+
+	  if (jobs < 1)
+	    {
+	      console << "Error: the number of jobs must be >= 1" << endl;
+	      return -1;
+	    }
+	}
+      else if (!strcmp(argv[first_cfg], "-resume"))
+	resume = true;
+      else
+	{
+	  console << "Error: invalid option " << argv[first_cfg] << endl;
+	  return -1;
+	}
+
+      first_cfg++;
+    }
+
+  if (argc <= first_cfg)
     {
-      cout << "Usage: " << argv[0] << " <cfg file> [<cfg file>]" << endl;
+      console << "Usage: " << argv[0] << " [-j <jobs>] [-resume] <cfg file> [<cfg file>]" << endl;
       return -1;
     }
 
-  for (int i=1; i<argc; i++)
+  for (int i=first_cfg; i<argc; i++)
     {
       string fname(argv[i]);
-      cout << "# Exploring configuration space " << fname << endl;
+      console << "# Exploring configuration space " << fname << endl;
 
       string error_msg;
 
-      if (!RunSimulations(fname, error_msg))
-	cout << "Error: " << error_msg << endl;
+      if (!RunSimulations(fname, jobs, resume, error_msg))
+	console << "Error: " << error_msg << endl;
 
-      cout << endl;
+      console << endl;
     }
 
   return 0;
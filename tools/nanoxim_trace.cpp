@@ -0,0 +1,331 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "TTraceFormat.h"
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Queries on the packet event traces written by nanoxim -trace FILE. The
+// trace is mapped in memory and scanned in place, see TTraceFormat.h
+
+#define SEGMENT_QUERY        "segment"
+#define NODE_QUERY           "node"
+#define SUMMARY_QUERY        "summary"
+#define ALL_RUNS             -1
+
+// The values below mirror the ones of nanoxim.h, which can't be
+// included without SystemC
+#define FIRST_ACTION         100
+#define NOT_VALID            -1
+
+static const char *direction_names[] = { "N", "E", "S", "W", "L" };
+
+static const char *action_names[] = {
+  "FLOOD", "DISCARD", "SKIP", "FORWARD_REQUEST", "END_CONFIRM",
+  "CONFIRM", "CANCEL_REQUEST", "END_CANCEL", "RETRY_REQUEST"
+};
+
+static const char *type_names[] = {
+  "STARTING_SEGMENT_REQUEST", "STARTING_SEGMENT_CONFIRM",
+  "SEGMENT_REQUEST", "SEGMENT_CONFIRM", "SEGMENT_CANCEL"
+};
+
+#define NAMES(v)             ((int)(sizeof(v)/sizeof(v[0])))
+
+//---------------------------------------------------------------------------
+
+struct TTraceFile
+{
+  TTraceHeader        *header;
+  const TTraceRecord  *records;
+  size_t               count;
+  size_t               size;
+};
+
+//---------------------------------------------------------------------------
+
+bool MapTrace(const string& fname, TTraceFile& trace, string& error_msg)
+{
+  int fd = open(fname.c_str(), O_RDONLY);
+
+  if (fd < 0)
+    {
+      error_msg = "cannot open " + fname;
+      return false;
+    }
+
+  struct stat st;
+
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TTraceHeader))
+    {
+      close(fd);
+      error_msg = fname + " is not a trace";
+      return false;
+    }
+
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (base == MAP_FAILED)
+    {
+      error_msg = "cannot map " + fname;
+      return false;
+    }
+
+  trace.header = (TTraceHeader *)base;
+  trace.records = (const TTraceRecord *)(trace.header + 1);
+  trace.size = st.st_size;
+  trace.count = (st.st_size - sizeof(TTraceHeader)) / sizeof(TTraceRecord);
+
+  if (strncmp(trace.header->magic, TRACE_MAGIC, sizeof(trace.header->magic)) != 0 ||
+      trace.header->version != TRACE_VERSION ||
+      trace.header->record_size != (int32_t)sizeof(TTraceRecord))
+    {
+      munmap(base, st.st_size);
+      error_msg = fname + " is not a trace of this version";
+      return false;
+    }
+
+  // Sequential scans, mostly
+  madvise(base, st.st_size, MADV_SEQUENTIAL);
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+string ActionName(const int action)
+{
+  if (action >= 0 && action < NAMES(direction_names))
+    return string("-> ") + direction_names[action];
+
+  if (action >= FIRST_ACTION && action - FIRST_ACTION < NAMES(action_names))
+    return action_names[action - FIRST_ACTION];
+
+  if (action == NOT_VALID)
+    return "NOT_VALID";
+
+  char buf[16];
+  sprintf(buf, "%d", action);
+
+  return buf;
+}
+
+//---------------------------------------------------------------------------
+
+string TypeName(const int type)
+{
+  if (type < NAMES(type_names))
+    return type_names[type];
+
+  return "?";
+}
+
+//---------------------------------------------------------------------------
+
+string DirectionName(const int dir)
+{
+  if (dir >= 0 && dir < NAMES(direction_names))
+    return direction_names[dir];
+
+  return "?";
+}
+
+//---------------------------------------------------------------------------
+
+// Blocks of different nodes are interleaved, put the events back in time
+bool EarlierEvent(const TTraceRecord *a, const TTraceRecord *b)
+{
+  if (a->run != b->run)
+    return a->run < b->run;
+
+  if (a->cycle != b->cycle)
+    return a->cycle < b->cycle;
+
+  return a->node < b->node;
+}
+
+//---------------------------------------------------------------------------
+
+void PrintEvents(vector<const TTraceRecord *>& events)
+{
+  stable_sort(events.begin(), events.end(), EarlierEvent);
+
+  cout << setw(4) << "run" << setw(10) << "cycle" << setw(7) << "node"
+       << setw(4) << "in" << "  " << setw(26) << left << "packet"
+       << setw(12) << "segment" << "action" << right << endl;
+
+  for (uint32_t i = 0; i < events.size(); i++)
+    {
+      const TTraceRecord *e = events[i];
+      char segment[32];
+
+      sprintf(segment, "(%d.%d)", e->segment_node, e->segment_link);
+
+      cout << setw(4) << e->run << setw(10) << e->cycle << setw(7) << e->node
+	   << setw(4) << DirectionName(e->dir_in) << "  " << setw(26) << left << TypeName(e->type)
+	   << setw(12) << segment << ActionName(e->action) << right << endl;
+    }
+
+  cout << events.size() << " events" << endl;
+}
+
+//---------------------------------------------------------------------------
+
+bool ParseSegment(const string& s, int& node, int& link)
+{
+  // Either 27.1 or (27.1)
+  if (sscanf(s.c_str(), "(%d.%d)", &node, &link) == 2)
+    return true;
+
+  return sscanf(s.c_str(), "%d.%d", &node, &link) == 2;
+}
+
+//---------------------------------------------------------------------------
+
+void QuerySegment(const TTraceFile& trace, const int run, const int node, const int link)
+{
+  vector<const TTraceRecord *> events;
+
+  for (size_t i = 0; i < trace.count; i++)
+    {
+      const TTraceRecord *r = &trace.records[i];
+
+      if (r->segment_node == node && r->segment_link == link &&
+	  (run == ALL_RUNS || r->run == run))
+	events.push_back(r);
+    }
+
+  PrintEvents(events);
+}
+
+//---------------------------------------------------------------------------
+
+void QueryNode(const TTraceFile& trace, const int run, const int node)
+{
+  vector<const TTraceRecord *> events;
+
+  for (size_t i = 0; i < trace.count; i++)
+    {
+      const TTraceRecord *r = &trace.records[i];
+
+      if (r->node == node && (run == ALL_RUNS || r->run == run))
+	events.push_back(r);
+    }
+
+  PrintEvents(events);
+}
+
+//---------------------------------------------------------------------------
+
+void QuerySummary(const TTraceFile& trace, const int run)
+{
+  map<string, uint32_t> by_type;
+  map<string, uint32_t> by_action;
+  map<int, uint32_t>    by_run;
+  int32_t last_cycle = 0;
+
+  for (size_t i = 0; i < trace.count; i++)
+    {
+      const TTraceRecord *r = &trace.records[i];
+
+      if (run != ALL_RUNS && r->run != run)
+	continue;
+
+      by_type[TypeName(r->type)]++;
+      by_action[ActionName(r->action)]++;
+      by_run[r->run]++;
+      last_cycle = max(last_cycle, r->cycle);
+    }
+
+  cout << "mesh: " << trace.header->mesh_dim_x << "x" << trace.header->mesh_dim_y << endl;
+  cout << "last cycle: " << last_cycle << endl;
+
+  for (map<int, uint32_t>::iterator i = by_run.begin(); i != by_run.end(); i++)
+    cout << "run " << i->first << ": " << i->second << " events" << endl;
+
+  for (map<string, uint32_t>::iterator i = by_type.begin(); i != by_type.end(); i++)
+    cout << "packet " << setw(26) << left << i->first << right << setw(10) << i->second << endl;
+
+  for (map<string, uint32_t>::iterator i = by_action.begin(); i != by_action.end(); i++)
+    cout << "action " << setw(26) << left << i->first << right << setw(10) << i->second << endl;
+}
+
+//---------------------------------------------------------------------------
+
+void ShowUsage(const char *selfname)
+{
+  cout << "Usage: " << selfname << " [-run R] <trace file> <query>" << endl
+       << "where <query> is one of:" << endl
+       << "\t" << SEGMENT_QUERY << " N.L\tevents of the packets of segment (N.L)" << endl
+       << "\t" << NODE_QUERY << " N\t\ttimeline of node N" << endl
+       << "\t" << SUMMARY_QUERY << "\t\tevents by packet type and action" << endl;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  int arg = 1;
+  int run = ALL_RUNS;
+
+  if (arg + 1 < argc && !strcmp(argv[arg], "-run"))
+    {
+      run = atoi(argv[arg + 1]);
+      arg += 2;
+    }
+
+  if (argc - arg < 2)
+    {
+      ShowUsage(argv[0]);
+      return -1;
+    }
+
+  TTraceFile trace;
+  string error_msg;
+
+  if (!MapTrace(argv[arg], trace, error_msg))
+    {
+      cerr << "Error: " << error_msg << endl;
+      return -1;
+    }
+
+  string query = argv[arg + 1];
+
+  if (query == SEGMENT_QUERY && argc - arg == 3)
+    {
+      int node, link;
+
+      if (!ParseSegment(argv[arg + 2], node, link))
+	{
+	  cerr << "Error: invalid segment " << argv[arg + 2] << endl;
+	  return -1;
+	}
+
+      QuerySegment(trace, run, node, link);
+    }
+  else if (query == NODE_QUERY && argc - arg == 3)
+    QueryNode(trace, run, atoi(argv[arg + 2]));
+  else if (query == SUMMARY_QUERY && argc - arg == 2)
+    QuerySummary(trace, run);
+  else
+    {
+      ShowUsage(argv[0]);
+      return -1;
+    }
+
+  munmap(trace.header, trace.size);
+
+  return 0;
+}